@@ -0,0 +1,85 @@
+//---------------------------------------------------------------------------
+// bitops.h
+// Developer: Yash Varde
+//---------------------------------------------------------------------------
+// Word-level bit helpers shared by the int set classes
+// -- popcount64() counts the set bits of a 64-bit word
+// -- ctz64() finds the index of the lowest set bit of a 64-bit word
+// -- select64() finds the index of the k-th set bit of a 64-bit word
+//
+// Implementation and Assumptions:
+// -- compiler intrinsics are used where available (GCC/Clang, MSVC x64)
+// -- a portable fallback is used everywhere else
+// -- ctz64() must not be called with a zero word
+// -- select64() must be given k below the number of set bits
+//---------------------------------------------------------------------------
+#ifndef BITOPS_H
+#define BITOPS_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// popcount64()
+// Returns the number of set bits in the given word
+// Preconditions: none
+// Postconditions: none
+inline int popcount64(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(word);
+#else
+    //clear the lowest set bit until none remain
+    int count = 0;
+    while (word != 0)
+    {
+        word &= word - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// ctz64()
+// Returns the index (0 to 63) of the lowest set bit in the given word
+// Preconditions: the word must not be zero
+// Postconditions: none
+inline int ctz64(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (int)index;
+#else
+    //shift right until the lowest bit is set
+    int index = 0;
+    while ((word & 1) == 0)
+    {
+        word >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+// select64()
+// Returns the index of the k-th lowest set bit (k = 0 is the lowest)
+// Preconditions: k must be below popcount64(word)
+// Postconditions: none
+inline int select64(uint64_t word, int k)
+{
+    //drop the k lowest set bits, then find the next one
+    for (int i = 0; i < k; i++)
+    {
+        word &= word - 1;
+    }
+    return ctz64(word);
+}
+
+#endif
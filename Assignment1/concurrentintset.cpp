@@ -0,0 +1,243 @@
+// a ConcurrentIntSet object holds positive integer values including zero
+// and can be updated by many threads at once without locks.
+
+#include "concurrentintset.h"
+#include <climits>
+
+//---------------------------------------------------------------------------
+
+ConcurrentIntSet::ConcurrentIntSet(int maxValue)
+{
+    //an IntSet's size (largest value + 1) is an int, so toIntSet() could
+    //not hold INT_MAX: the range stops at INT_MAX - 1
+    if (maxValue > INT_MAX - 1)
+    {
+        maxValue = INT_MAX - 1;
+    }
+
+    //one directory slot per segment needed to reach maxValue (dividing
+    //before adding, so maxValue near INT_MAX cannot overflow)
+    this->maxValue = (maxValue < 0) ? -1 : maxValue;
+    segmentCount = (maxValue < 0) ? 0 : this->maxValue / SEGMENT_VALUES + 1;
+    directory = new atomic<Segment*>[segmentCount];
+
+    //no segments yet: they are allocated on first insert
+    for (int i = 0; i < segmentCount; i++)
+    {
+        directory[i].store(nullptr, memory_order_relaxed);
+    }
+}
+
+//---------------------------------------------------------------------------
+
+ConcurrentIntSet::~ConcurrentIntSet()
+{
+    for (int i = 0; i < segmentCount; i++)
+    {
+        delete directory[i].load(memory_order_relaxed);
+    }
+    delete[] directory;
+    directory = nullptr;
+    segmentCount = 0;
+}
+
+//---------------------------------------------------------------------------
+
+bool ConcurrentIntSet::insert(int x)
+{
+    //int argument might be negative or too large
+    if (x < 0 || x > maxValue)
+    {
+        return false;
+    }
+
+    //set the bit; the old word says whether another call got there first
+    Segment* segment = getOrCreateSegment(x);
+    int index = x % SEGMENT_VALUES;
+    uint64_t bit = uint64_t(1) << (index % WORD_BITS);
+    uint64_t old = segment->words[index / WORD_BITS].fetch_or(bit,
+        memory_order_acq_rel);
+    return (old & bit) == 0;
+}
+
+//---------------------------------------------------------------------------
+
+bool ConcurrentIntSet::remove(int x)
+{
+    //values out of range, or in a segment never written, are not in the set
+    Segment* segment = (x < 0 || x > maxValue) ? nullptr : getSegment(x);
+    if (segment == nullptr)
+    {
+        return false;
+    }
+
+    //clear the bit; the old word says whether it was set
+    int index = x % SEGMENT_VALUES;
+    uint64_t bit = uint64_t(1) << (index % WORD_BITS);
+    uint64_t old = segment->words[index / WORD_BITS].fetch_and(~bit,
+        memory_order_acq_rel);
+    return (old & bit) != 0;
+}
+
+//---------------------------------------------------------------------------
+
+bool ConcurrentIntSet::isInSet(int x) const
+{
+    Segment* segment = (x < 0 || x > maxValue) ? nullptr : getSegment(x);
+    if (segment == nullptr)
+    {
+        return false;
+    }
+
+    int index = x % SEGMENT_VALUES;
+    uint64_t word = segment->words[index / WORD_BITS].load(
+        memory_order_acquire);
+    return ((word >> (index % WORD_BITS)) & 1) != 0;
+}
+
+//---------------------------------------------------------------------------
+
+bool ConcurrentIntSet::operator[](int x) const
+{
+    return isInSet(x);
+}
+
+//---------------------------------------------------------------------------
+
+int ConcurrentIntSet::getMaxValue() const
+{
+    return maxValue;
+}
+
+//---------------------------------------------------------------------------
+
+IntSet ConcurrentIntSet::toIntSet() const
+{
+    //first pass: count the members and find the highest one, loading only
+    //the words of allocated segments, so the cost follows the populated
+    //segments rather than maxValue
+    int members = 0;
+    int highestWord = -1;
+    uint64_t highestBits = 0;
+    for (int s = 0; s < segmentCount; s++)
+    {
+        Segment* segment = directory[s].load(memory_order_acquire);
+        if (segment == nullptr)
+        {
+            continue;
+        }
+
+        for (int w = 0; w < SEGMENT_WORDS; w++)
+        {
+            uint64_t word = segment->words[w].load(memory_order_acquire);
+            if (word != 0)
+            {
+                members += popcount64(word);
+                highestWord = s * SEGMENT_WORDS + w;
+                highestBits = word;
+            }
+        }
+    }
+
+    IntSet result;
+    if (highestWord == -1)
+    {
+        return result;
+    }
+
+    //size the result once to end at the highest member, as inserting the
+    //members would; if the words would be mostly empty, extend() puts the
+    //result in sparse mode instead
+    int top = WORD_BITS - 1;
+    while ((highestBits >> top) == 0)
+    {
+        top--;
+    }
+    result.extend(highestWord * WORD_BITS + top + 1, members);
+
+    //second pass: copy whole words in. Bits set past the highest member
+    //since the first pass are left out, like any write after the copy.
+    uint64_t lastMask = ~uint64_t(0) >> (WORD_BITS - 1 - top);
+    for (int s = 0; s <= highestWord / SEGMENT_WORDS; s++)
+    {
+        Segment* segment = directory[s].load(memory_order_acquire);
+        if (segment == nullptr)
+        {
+            continue;
+        }
+
+        for (int w = 0; w < SEGMENT_WORDS; w++)
+        {
+            int index = s * SEGMENT_WORDS + w;
+            if (index > highestWord)
+            {
+                break;
+            }
+            uint64_t word = segment->words[w].load(memory_order_acquire);
+            if (index == highestWord)
+            {
+                word &= lastMask;
+            }
+
+            //sparse mode takes the values one at a time (there are fewer
+            //of them than words)
+            if (result.sparse != nullptr)
+            {
+                for (; word != 0; word &= word - 1)
+                {
+                    result.sparse->insert(index * WORD_BITS + ctz64(word));
+                }
+            }
+            else
+            {
+                result.arraySet[index] = word;
+                result.population += popcount64(word);
+            }
+        }
+    }
+    if (result.sparse != nullptr)
+    {
+        result.population = result.sparse->count();
+    }
+
+    return result;
+}
+
+//---------------------------------------------------------------------------
+
+ConcurrentIntSet::Segment* ConcurrentIntSet::getSegment(int x) const
+{
+    return directory[x / SEGMENT_VALUES].load(memory_order_acquire);
+}
+
+//---------------------------------------------------------------------------
+
+ConcurrentIntSet::Segment* ConcurrentIntSet::getOrCreateSegment(int x)
+{
+    //already allocated: the common case is one atomic load
+    atomic<Segment*>& slot = directory[x / SEGMENT_VALUES];
+    Segment* segment = slot.load(memory_order_acquire);
+    if (segment != nullptr)
+    {
+        return segment;
+    }
+
+    //allocate a zeroed segment and try to publish it
+    Segment* created = new Segment;
+    for (int w = 0; w < SEGMENT_WORDS; w++)
+    {
+        created->words[w].store(0, memory_order_relaxed);
+    }
+
+    if (slot.compare_exchange_strong(segment, created,
+        memory_order_acq_rel, memory_order_acquire))
+    {
+        return created;
+    }
+
+    //another thread published first: use its segment instead
+    delete created;
+    return segment;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,113 @@
+//---------------------------------------------------------------------------
+// class ConcurrentIntSet
+// Developer: Yash Varde
+//---------------------------------------------------------------------------
+// ADT ConcurrentIntSet: a set of positive integers (zero inclusive) that
+// many threads can insert into, remove from and query at the same time
+// -- insert(), remove() and isInSet() are lock-free
+// -- toIntSet() takes a snapshot as a regular IntSet for set algebra
+//
+// Implementation and Assumptions:
+// -- values are packed into 64-bit atomic words, one bit per value
+// -- words are grouped into segments of SEGMENT_VALUES values; a segment is
+//    only allocated the first time a value inside it is inserted, and is
+//    never moved or freed until the set is destroyed, so readers never see
+//    a reallocation
+// -- the directory of segment pointers is sized once, from the maximum
+//    value given to the constructor (at most INT_MAX - 1, as with IntSet);
+//    values above it are rejected
+// -- insert() uses atomic fetch-or and remove() atomic fetch-and, so each
+//    returns whether this call changed the set
+// -- operations on different values are independent; a snapshot taken
+//    while other threads are writing reflects some order of those writes
+//    for each word, not one instant for the whole set
+// -- the set cannot be copied (copying would not be atomic)
+//---------------------------------------------------------------------------
+#ifndef CONCURRENTINTSET_H
+#define CONCURRENTINTSET_H
+
+#include <atomic>
+#include <cstdint>
+#include "intset.h"
+
+class ConcurrentIntSet
+{
+public:
+    // Constructor
+    // Creates an empty set able to hold values from 0 to maxValue
+    // Preconditions: maxValue must not be negative
+    // Postconditions: no segments are allocated yet; a maxValue above
+    //                 INT_MAX - 1 (the largest value an IntSet can hold)
+    //                 is lowered to INT_MAX - 1
+    explicit ConcurrentIntSet(int maxValue);
+
+    // Destructor
+    // Preconditions: no other thread may be using the set
+    // Postconditions: all segments are released
+    ~ConcurrentIntSet();
+
+    ConcurrentIntSet(const ConcurrentIntSet&) = delete;
+    ConcurrentIntSet& operator = (const ConcurrentIntSet&) = delete;
+
+    // insert()
+    // inserts the supplied integer into the set (safe from any thread)
+    // Preconditions: none
+    // Postconditions: returns true if this call added the value; false if
+    //                 it was already in the set or is out of range
+    bool insert(int);
+
+    // remove()
+    // removes the supplied integer from the set (safe from any thread)
+    // Preconditions: none
+    // Postconditions: returns true if this call removed the value
+    bool remove(int);
+
+    // isInSet()
+    // Checks whether the given int is within the set (safe from any thread)
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    bool isInSet(int) const;
+
+    // operator []
+    // Same as isInSet()
+    bool operator [] (int) const;
+
+    // getMaxValue()
+    // Returns the largest value the set can hold
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    int getMaxValue() const;
+
+    // toIntSet()
+    // Copies the current members into a regular IntSet, whose size ends at
+    // the highest member; only the allocated segments are read
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    IntSet toIntSet() const;
+
+private:
+    static const int WORD_BITS = 64;                    //values per word
+    static const int SEGMENT_WORDS = 1024;              //words per segment
+    static const int SEGMENT_VALUES = SEGMENT_WORDS * WORD_BITS;
+
+    //Segment
+    //a block of atomic words covering SEGMENT_VALUES consecutive values
+    struct Segment
+    {
+        atomic<uint64_t> words[SEGMENT_WORDS];
+    };
+
+    atomic<Segment*>* directory;        //one segment pointer per block
+    int segmentCount;                   //length of the directory
+    int maxValue;                       //largest value that can be held
+
+    // getSegment()
+    // Returns the segment holding the value, or null if not allocated yet
+    Segment* getSegment(int) const;
+
+    // getOrCreateSegment()
+    // Returns the segment holding the value, allocating it if needed. When
+    // two threads race, one allocation wins and the other is discarded.
+    Segment* getOrCreateSegment(int);
+};
+#endif
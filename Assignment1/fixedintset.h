@@ -0,0 +1,284 @@
+//---------------------------------------------------------------------------
+// class FixedIntSet<N>
+// Developer: Yash Varde
+//---------------------------------------------------------------------------
+// ADT FixedIntSet: a set of positive integers (zero inclusive) below N,
+// where N is fixed at compile time
+// -- same operator surface as IntSet: union (+), intersection (*),
+//    difference (-), compound assignment, ==, !=, << and >>
+// -- everything except << and >> is constexpr, so sets and tables built
+//    from them can be computed at compile time and checked with
+//    static_assert, e.g.
+//        constexpr FixedIntSet<16> primes(2, 3, 5, 7, 11);
+//        static_assert((primes - FixedIntSet<16>(2)).count() == 4, "");
+//
+// Implementation and Assumptions:
+// -- membership is packed into a std::array of 64-bit words, one bit per
+//    value, held inside the object; the heap is never used
+// -- the word count is a compile-time constant, so the compiler can unroll
+//    every set operation completely
+// -- values outside 0 to N - 1 cannot be inserted (insert returns false)
+// -- getSize() is always N; count() is computed from the words
+// -- in <<, integers are preceded by a space, as with IntSet
+// -- in >>, integers are read until -1, as with IntSet; a non-integer or
+//    the end of input before the -1 stops the read and sets failbit
+//---------------------------------------------------------------------------
+#ifndef FIXEDINTSET_H
+#define FIXEDINTSET_H
+
+#include <iostream>
+#include <array>
+#include <cstdint>
+using namespace std;
+
+template <int N>
+class FixedIntSet
+{
+    static_assert(N > 0, "FixedIntSet must be able to hold a value");
+
+public:
+    // Constructor with int parameters
+    // Allows for up to five int arguments to be inserted by user.
+    // Preconditions: only integers should be entered to work properly.
+    // Postconditions: a set containing the ints below N is instantiated.
+    constexpr FixedIntSet(int a = -1, int b = -1, int c = -1, int d = -1,
+        int e = -1) : words()
+    {
+        insert(a);
+        insert(b);
+        insert(c);
+        insert(d);
+        insert(e);
+    }
+
+    // operator +, *, -
+    // Return the union, intersection or difference of two sets
+    // Preconditions: none
+    // Postconditions: both sets remain unchanged
+    friend constexpr FixedIntSet operator + (FixedIntSet left,
+        const FixedIntSet& right)
+    {
+        return left += right;
+    }
+
+    friend constexpr FixedIntSet operator * (FixedIntSet left,
+        const FixedIntSet& right)
+    {
+        return left *= right;
+    }
+
+    friend constexpr FixedIntSet operator - (FixedIntSet left,
+        const FixedIntSet& right)
+    {
+        return left -= right;
+    }
+
+    // operator +=, *=, -=
+    // modifies current object to be the union, intersection or difference
+    // of itself and the other
+    // Preconditions: none
+    // Postconditions: "this" set holds the result
+    constexpr FixedIntSet& operator += (const FixedIntSet& other)
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    constexpr FixedIntSet& operator *= (const FixedIntSet& other)
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+
+    constexpr FixedIntSet& operator -= (const FixedIntSet& other)
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            words[i] &= ~other.words[i];
+        }
+        return *this;
+    }
+
+    // operator ==, !=
+    // Checks whether two sets hold the same values
+    // Preconditions: none
+    // Postconditions: both sets remain unchanged
+    constexpr bool operator == (const FixedIntSet& other) const
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            if (words[i] != other.words[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool operator != (const FixedIntSet& other) const
+    {
+        return !(*this == other);
+    }
+
+    // insert()
+    // inserts the supplied integer into the set
+    // Preconditions: none
+    // Postconditions: returns false if the value is not between 0 and N - 1
+    constexpr bool insert(int x)
+    {
+        if (x < 0 || x >= N)
+        {
+            return false;
+        }
+        words[x / WORD_BITS] |= uint64_t(1) << (x % WORD_BITS);
+        return true;
+    }
+
+    // remove()
+    // removes the supplied integer from the set
+    // Preconditions: none
+    // Postconditions: returns true if the value was in the set
+    constexpr bool remove(int x)
+    {
+        if (!isInSet(x))
+        {
+            return false;
+        }
+        words[x / WORD_BITS] &= ~(uint64_t(1) << (x % WORD_BITS));
+        return true;
+    }
+
+    // isEmpty()
+    // checks whether the set holds no values
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    constexpr bool isEmpty() const
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            if (words[i] != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // isInSet()
+    // Checks whether the given int is within the set
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    constexpr bool isInSet(int x) const
+    {
+        return x >= 0 && x < N &&
+            ((words[x / WORD_BITS] >> (x % WORD_BITS)) & 1) != 0;
+    }
+
+    // containsSet()
+    // Checks whether every value of the given set is within this set
+    // Preconditions: none
+    // Postconditions: both sets remain unchanged
+    constexpr bool containsSet(const FixedIntSet& subset) const
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            if ((subset.words[i] & ~words[i]) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // operator []
+    // Same as isInSet()
+    constexpr bool operator [] (int x) const
+    {
+        return isInSet(x);
+    }
+
+    // getSize()
+    // Returns the number of possible values (always N)
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    constexpr int getSize() const
+    {
+        return N;
+    }
+
+    // count()
+    // Returns the number of values in the set
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    constexpr int count() const
+    {
+        int total = 0;
+        for (int i = 0; i < WORDS; i++)
+        {
+            total += countBits(words[i]);
+        }
+        return total;
+    }
+
+    // operator >>
+    // Overloaded input operator. Inputs values until -1 is read.
+    // Preconditions: the set must already be declared.
+    // Postconditions: the set contains the ints below N that were input;
+    //                 anything else (or the end of input) before the -1
+    //                 stops the read and sets failbit
+    friend istream& operator >> (istream& stream, FixedIntSet& set)
+    {
+        //a failed read leaves failbit set and stops the loop
+        int x = 0;
+        while (stream >> x && x != -1)
+        {
+            set.insert(x);
+        }
+
+        return stream;
+    }
+
+    // operator <<
+    // Overloaded output operator. Outputs values within the set.
+    // Preconditions: none
+    // Postconditions: the set remains unchanged
+    friend ostream& operator << (ostream& stream, const FixedIntSet& set)
+    {
+        stream << "{";
+        for (int x = 0; x < N; x++)
+        {
+            if (set.isInSet(x))
+            {
+                stream << " " << x;
+            }
+        }
+        stream << "}" << "\n";
+
+        return stream;
+    }
+
+private:
+    static const int WORD_BITS = 64;                        //values per word
+    static const int WORDS = (N + WORD_BITS - 1) / WORD_BITS;//words held
+
+    array<uint64_t, WORDS> words;           //one bit per possible value
+
+    // countBits()
+    // Returns the number of set bits in a word (constexpr, unlike the
+    // compiler intrinsics used by popcount64())
+    static constexpr int countBits(uint64_t word)
+    {
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) +
+            ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (int)((word * 0x0101010101010101ULL) >> 56);
+    }
+};
+#endif
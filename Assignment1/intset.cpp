@@ -1,6 +1,660 @@
 // an IntSet object holds positive integer values including zero.
 
 #include "intset.h"
+#include "bitops.h"
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <system_error>
+#include <new>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <charconv>
+#include <locale>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define INTSET_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define INTSET_SSE2
+#define INTSET_AVX2
+#else
+#define INTSET_SSE2 __attribute__((target("sse2")))
+#define INTSET_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+#endif
+
+//---------------------------------------------------------------------------
+// Word kernels
+// The set operators work on whole blocks of words through a table of
+// kernels. The table is chosen once at runtime: AVX2 (4 words per step) or
+// SSE2 (2 words per step) when the processor has them, scalar otherwise.
+// Every kernel finishes the words that do not fill a whole vector one at a
+// time, so word counts need not be a multiple of the vector width.
+
+struct SetKernels
+{
+    //dest[i] = a[i] | b[i], dest[i] = a[i] & b[i], dest[i] = a[i] & ~b[i];
+    //each returns the number of bits set in the words it wrote
+    int (*orWords)(uint64_t*, const uint64_t*, const uint64_t*, int);
+    int (*andWords)(uint64_t*, const uint64_t*, const uint64_t*, int);
+    int (*andNotWords)(uint64_t*, const uint64_t*, const uint64_t*, int);
+
+    //true if every bit of the first array is also set in the second
+    bool (*subsetWords)(const uint64_t*, const uint64_t*, int);
+
+    //true if both arrays hold exactly the same bits
+    bool (*equalWords)(const uint64_t*, const uint64_t*, int);
+
+    //number of bits set in both arrays (nothing is written)
+    int (*andCountWords)(const uint64_t*, const uint64_t*, int);
+};
+
+static int orWordsScalar(uint64_t* dest, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int count = 0;
+    for (int i = 0; i < n; i++)
+    {
+        dest[i] = a[i] | b[i];
+        count += popcount64(dest[i]);
+    }
+    return count;
+}
+
+static int andWordsScalar(uint64_t* dest, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int count = 0;
+    for (int i = 0; i < n; i++)
+    {
+        dest[i] = a[i] & b[i];
+        count += popcount64(dest[i]);
+    }
+    return count;
+}
+
+static int andNotWordsScalar(uint64_t* dest, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int count = 0;
+    for (int i = 0; i < n; i++)
+    {
+        dest[i] = a[i] & ~b[i];
+        count += popcount64(dest[i]);
+    }
+    return count;
+}
+
+static bool subsetWordsScalar(const uint64_t* sub, const uint64_t* super,
+    int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if ((sub[i] & ~super[i]) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool equalWordsScalar(const uint64_t* a, const uint64_t* b, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int andCountWordsScalar(const uint64_t* a, const uint64_t* b, int n)
+{
+    int count = 0;
+    for (int i = 0; i < n; i++)
+    {
+        count += popcount64(a[i] & b[i]);
+    }
+    return count;
+}
+
+#ifdef INTSET_X86
+
+INTSET_SSE2 static int orWordsSse2(uint64_t* dest, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int count = 0;
+    int i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dest + i), _mm_or_si128(x, y));
+        count += popcount64(dest[i]) + popcount64(dest[i + 1]);
+    }
+    return count + orWordsScalar(dest + i, a + i, b + i, n - i);
+}
+
+INTSET_SSE2 static int andWordsSse2(uint64_t* dest, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int count = 0;
+    int i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dest + i), _mm_and_si128(x, y));
+        count += popcount64(dest[i]) + popcount64(dest[i + 1]);
+    }
+    return count + andWordsScalar(dest + i, a + i, b + i, n - i);
+}
+
+INTSET_SSE2 static int andNotWordsSse2(uint64_t* dest, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int count = 0;
+    int i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        //_mm_andnot_si128 complements its FIRST operand
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dest + i), _mm_andnot_si128(y, x));
+        count += popcount64(dest[i]) + popcount64(dest[i + 1]);
+    }
+    return count + andNotWordsScalar(dest + i, a + i, b + i, n - i);
+}
+
+INTSET_SSE2 static bool subsetWordsSse2(const uint64_t* sub,
+    const uint64_t* super, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(sub + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(super + i));
+        __m128i missing = _mm_andnot_si128(y, x);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(missing, zero)) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+    return subsetWordsScalar(sub + i, super + i, n - i);
+}
+
+INTSET_SSE2 static bool equalWordsSse2(const uint64_t* a, const uint64_t* b,
+    int n)
+{
+    int i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+    return equalWordsScalar(a + i, b + i, n - i);
+}
+
+INTSET_AVX2 static int orWordsAvx2(uint64_t* dest, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(dest + i), _mm256_or_si256(x, y));
+        count += popcount64(dest[i]) + popcount64(dest[i + 1]) +
+            popcount64(dest[i + 2]) + popcount64(dest[i + 3]);
+    }
+    return count + orWordsScalar(dest + i, a + i, b + i, n - i);
+}
+
+INTSET_AVX2 static int andWordsAvx2(uint64_t* dest, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(dest + i), _mm256_and_si256(x, y));
+        count += popcount64(dest[i]) + popcount64(dest[i + 1]) +
+            popcount64(dest[i + 2]) + popcount64(dest[i + 3]);
+    }
+    return count + andWordsScalar(dest + i, a + i, b + i, n - i);
+}
+
+INTSET_AVX2 static int andNotWordsAvx2(uint64_t* dest, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        //_mm256_andnot_si256 complements its FIRST operand
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(dest + i), _mm256_andnot_si256(y, x));
+        count += popcount64(dest[i]) + popcount64(dest[i + 1]) +
+            popcount64(dest[i + 2]) + popcount64(dest[i + 3]);
+    }
+    return count + andNotWordsScalar(dest + i, a + i, b + i, n - i);
+}
+
+INTSET_AVX2 static bool subsetWordsAvx2(const uint64_t* sub,
+    const uint64_t* super, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        //testc is 1 when every bit of sub is also set in super
+        __m256i x = _mm256_loadu_si256((const __m256i*)(sub + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(super + i));
+        if (!_mm256_testc_si256(y, x))
+        {
+            return false;
+        }
+    }
+    return subsetWordsScalar(sub + i, super + i, n - i);
+}
+
+INTSET_AVX2 static bool equalWordsAvx2(const uint64_t* a, const uint64_t* b,
+    int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i diff = _mm256_xor_si256(x, y);
+        if (!_mm256_testz_si256(diff, diff))
+        {
+            return false;
+        }
+    }
+    return equalWordsScalar(a + i, b + i, n - i);
+}
+
+INTSET_AVX2 static int andCountWordsAvx2(const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    //count the bits of every byte by looking up each half in a 16-entry
+    //table, then add the byte counts into four 64-bit totals
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+        1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowHalf = _mm256_set1_epi8(0x0F);
+    __m256i totals = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i both = _mm256_and_si256(x, y);
+        __m256i low = _mm256_shuffle_epi8(table,
+            _mm256_and_si256(both, lowHalf));
+        __m256i high = _mm256_shuffle_epi8(table,
+            _mm256_and_si256(_mm256_srli_epi16(both, 4), lowHalf));
+        totals = _mm256_add_epi64(totals, _mm256_sad_epu8(
+            _mm256_add_epi8(low, high), _mm256_setzero_si256()));
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, totals);
+    return (int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) +
+        andCountWordsScalar(a + i, b + i, n - i);
+}
+
+//cpuHas()
+//checks whether the processor (and the OS, for AVX2) supports the kernels
+static bool cpuHasSse2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 1);
+    return (regs[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    //AVX must be enabled by the OS (OSXSAVE + YMM state) before AVX2 is used
+    int regs[4];
+    __cpuid(regs, 1);
+    bool osSavesYmm = (regs[2] & (1 << 27)) != 0 && (regs[2] & (1 << 28)) != 0
+        && (_xgetbv(0) & 6) == 6;
+    __cpuidex(regs, 7, 0);
+    return osSavesYmm && (regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+//countWords()
+//returns the number of bits set in the given words
+static int countWords(const uint64_t* words, int n)
+{
+    int count = 0;
+    for (int i = 0; i < n; i++)
+    {
+        count += popcount64(words[i]);
+    }
+    return count;
+}
+
+//chooseKernels()
+//picks the widest kernel table the running processor supports
+static SetKernels chooseKernels()
+{
+#ifdef INTSET_X86
+    if (cpuHasAvx2())
+    {
+        return { orWordsAvx2, andWordsAvx2, andNotWordsAvx2,
+            subsetWordsAvx2, equalWordsAvx2, andCountWordsAvx2 };
+    }
+    if (cpuHasSse2())
+    {
+        //SSE2 has no byte shuffle for a table lookup, so counting is scalar
+        return { orWordsSse2, andWordsSse2, andNotWordsSse2,
+            subsetWordsSse2, equalWordsSse2, andCountWordsScalar };
+    }
+#endif
+    return { orWordsScalar, andWordsScalar, andNotWordsScalar,
+        subsetWordsScalar, equalWordsScalar, andCountWordsScalar };
+}
+
+//kernels()
+//returns the kernel table, choosing it on first use
+static const SetKernels& kernels()
+{
+    static const SetKernels chosen = chooseKernels();
+    return chosen;
+}
+
+//---------------------------------------------------------------------------
+// Parallel word operations
+// Sets larger than PARALLEL_WORDS words are split into one contiguous block
+// per hardware thread. Block edges fall on cache-line boundaries of the
+// destination, so no two threads write the same line. The calling thread
+// works on the first block while the others run on new threads. Subset and
+// equality checks share a flag: every thread checks it between slices and
+// stops as soon as any thread has found a mismatch.
+
+static const int PARALLEL_WORDS = 1 << 18;      //2 MB of words per operand
+static const int MIN_THREAD_WORDS = 1 << 16;    //smallest block per thread
+static const int LINE_WORDS = 8;                //words per 64-byte line
+static const int SLICE_WORDS = 1 << 12;         //words between flag checks
+
+typedef int (*BinaryKernel)(uint64_t*, const uint64_t*, const uint64_t*, int);
+typedef bool (*CompareKernel)(const uint64_t*, const uint64_t*, int);
+typedef int (*CountKernel)(const uint64_t*, const uint64_t*, int);
+
+//threadCount()
+//returns how many threads should share an operation over n words
+static int threadCount(int n)
+{
+    if (n < PARALLEL_WORDS)
+    {
+        return 1;
+    }
+    int hardware = (int)thread::hardware_concurrency();
+    return max(1, min(hardware, n / MIN_THREAD_WORDS));
+}
+
+//splitWords()
+//fills edges[0..parts] with block edges over n words; inner edges are
+//moved up to the next cache line of base
+static void splitWords(const uint64_t* base, int n, int parts,
+    vector<int>& edges)
+{
+    //words before base's first cache line boundary
+    int lead = (int)((LINE_WORDS - ((uintptr_t)base / sizeof(uint64_t))
+        % LINE_WORDS) % LINE_WORDS);
+
+    edges.assign(parts + 1, n);
+    edges[0] = 0;
+    for (int p = 1; p < parts; p++)
+    {
+        long long edge = (long long)n * p / parts;
+        edge += (lead - edge % LINE_WORDS + LINE_WORDS) % LINE_WORDS;
+        edges[p] = (int)min((long long)n, max((long long)edges[p - 1], edge));
+    }
+}
+
+//runParts()
+//runs work(p) for every block p, the first on the calling thread. A block
+//whose thread cannot be started runs on the calling thread instead.
+template <class Work>
+static void runParts(int parts, Work work)
+{
+    vector<thread> workers;
+    workers.reserve(parts - 1);
+    for (int p = 1; p < parts; p++)
+    {
+        try
+        {
+            workers.emplace_back(work, p);
+        }
+        catch (const system_error&)
+        {
+            work(p);
+        }
+    }
+    work(0);
+    for (thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+//applyWords()
+//runs a binary kernel over n words, in parallel for large sets; returns the
+//number of bits set in the words written
+static int applyWords(BinaryKernel kernel, uint64_t* dest, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int parts = threadCount(n);
+    if (parts == 1)
+    {
+        return kernel(dest, a, b, n);
+    }
+
+    vector<int> edges;
+    splitWords(dest, n, parts, edges);
+    vector<int> counts(parts, 0);
+    runParts(parts, [&](int p)
+    {
+        counts[p] = kernel(dest + edges[p], a + edges[p], b + edges[p],
+            edges[p + 1] - edges[p]);
+    });
+
+    int count = 0;
+    for (int part : counts)
+    {
+        count += part;
+    }
+    return count;
+}
+
+//countPairWords()
+//runs a counting kernel over n words, in parallel for large sets
+static int countPairWords(CountKernel kernel, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int parts = threadCount(n);
+    if (parts == 1)
+    {
+        return kernel(a, b, n);
+    }
+
+    vector<int> edges;
+    splitWords(a, n, parts, edges);
+    vector<int> counts(parts, 0);
+    runParts(parts, [&](int p)
+    {
+        counts[p] = kernel(a + edges[p], b + edges[p], edges[p + 1] - edges[p]);
+    });
+
+    int count = 0;
+    for (int part : counts)
+    {
+        count += part;
+    }
+    return count;
+}
+
+//testWords()
+//runs a subset or equality kernel over n words, in parallel for large sets;
+//every thread stops once any thread finds a mismatch
+static bool testWords(CompareKernel kernel, const uint64_t* a,
+    const uint64_t* b, int n)
+{
+    int parts = threadCount(n);
+    if (parts == 1)
+    {
+        return kernel(a, b, n);
+    }
+
+    vector<int> edges;
+    splitWords(a, n, parts, edges);
+    atomic<bool> mismatch(false);
+    runParts(parts, [&](int p)
+    {
+        for (int i = edges[p]; i < edges[p + 1]; i += SLICE_WORDS)
+        {
+            if (mismatch.load(memory_order_relaxed))
+            {
+                return;
+            }
+            if (!kernel(a + i, b + i, min(SLICE_WORDS, edges[p + 1] - i)))
+            {
+                mismatch.store(true, memory_order_relaxed);
+                return;
+            }
+        }
+    });
+    return !mismatch.load();
+}
+
+//---------------------------------------------------------------------------
+// Snapshot files
+// A snapshot is a 64-byte header followed by the set's words exactly as
+// they are held in memory. The header records a version and the byte order
+// the words were written in, so a file from another format or machine is
+// rejected instead of misread. Mapped files start on a page boundary, so
+// the words that follow the header start on a cache line.
+
+static const char SNAPSHOT_MAGIC[8] = { 'I', 'N', 'T', 'S', 'E', 'T', 0, 0 };
+static const uint32_t SNAPSHOT_VERSION = 1;
+static const uint64_t SNAPSHOT_BYTE_ORDER = 0x0102030405060708ULL;
+static const int SNAPSHOT_BLOCK_WORDS = 512;   //words per write in sparse mode
+
+struct SnapshotHeader
+{
+    char magic[8];              //SNAPSHOT_MAGIC
+    uint32_t version;           //SNAPSHOT_VERSION
+    uint32_t headerBytes;       //size of this header; the words follow it
+    uint64_t byteOrder;         //SNAPSHOT_BYTE_ORDER as the writer stored it
+    int64_t size;               //number of possible values
+    int64_t population;         //number of values in the set
+    int64_t words;              //number of words after the header
+    uint64_t reserved[2];       //zero; pads the header to 64 bytes
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header is 64 bytes");
+
+//mapFile()
+//maps a whole file into memory read-only; returns null on failure
+static void* mapFile(const char* path, size_t& bytes)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    LARGE_INTEGER length;
+    void* base = nullptr;
+    if (GetFileSizeEx(file, &length) && length.QuadPart > 0)
+    {
+        //the view stays valid after both handles are closed
+        HANDLE view = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0,
+            nullptr);
+        if (view != nullptr)
+        {
+            base = MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(view);
+        }
+        bytes = (size_t)length.QuadPart;
+    }
+    CloseHandle(file);
+    return base;
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat info;
+    void* base = nullptr;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        //the mapping stays valid after the file is closed
+        base = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE,
+            file, 0);
+        if (base == MAP_FAILED)
+        {
+            base = nullptr;
+        }
+        bytes = (size_t)info.st_size;
+    }
+    close(file);
+    return base;
+#endif
+}
+
+//unmapFile()
+//releases a mapping made by mapFile()
+static void unmapFile(void* base, size_t bytes)
+{
+#ifdef _WIN32
+    (void)bytes;
+    UnmapViewOfFile(base);
+#else
+    munmap(base, bytes);
+#endif
+}
 
 //---------------------------------------------------------------------------
 
@@ -12,417 +666,1757 @@ IntSet::IntSet(int a, int b, int c, int d, int e)
     max = std::max(max, c);
     max = std::max(max, d);
     max = std::max(max, e);
-    
-    //create a new array with a size of (max + 1)
-    size = max + 1;
-    arraySet = new bool[size];
 
-    //initialize all values to false (empty set)
-    for (int i = 0; i < size; i++)
-    {
-        arraySet[i] = false;
-    }
+    //create an empty word array able to hold (max + 1) values; small sets
+    //stay in the inline words, and large ones that would be mostly empty
+    //start in sparse mode
+    useInlineWords();
+    size = 0;
+    population = 0;
+    mapping = nullptr;
+    mappingBytes = 0;
+    sparse = nullptr;
+    max = std::max(max, -1);
+    int values = (max < MAX_VALUE ? max : MAX_VALUE) + 1;
+    if (prefersSparse(wordsFor(values), 5))
+    {
+        makeSparse();
+        size = values;
+    }
+    else
+    {
+        allocate(values);
+    }
+
+    //attempt to insert each of the arguments
+    insert(a);
+    insert(b);
+    insert(c);
+    insert(d);
+    insert(e);
+}
+
+//---------------------------------------------------------------------------
+IntSet::IntSet(const IntSet& source)
+{
+    //start from an empty set so that the assignment operator can reallocate
+    useInlineWords();
+    size = 0;
+    population = 0;
+    mapping = nullptr;
+    mappingBytes = 0;
+    sparse = nullptr;
+
+    //call the assignment operator
+    *this = source;
+}
+
+//---------------------------------------------------------------------------
+
+IntSet::IntSet(IntSet&& source) noexcept
+{
+    takeWords(source);
+}
+
+//---------------------------------------------------------------------------
+
+IntSet::~IntSet()
+{
+    releaseWords();
+    dropRankDirectory();
+    delete sparse;
+    size = 0;
+    population = 0;
+}
+
+//---------------------------------------------------------------------------
+
+IntSet& IntSet::operator=(const IntSet& source)
+{
+    //check whether source is being assigned to itself
+    if (this == &source)
+    {
+        return *this;
+    }
+
+    //chunks of a sparse set are copied
+    if (source.sparse != nullptr)
+    {
+        SparseIntSet* chunks = new SparseIntSet(*source.sparse);
+        releaseWords();
+        useInlineWords();
+        delete sparse;
+        sparse = chunks;
+        size = source.size;
+        population = source.population;
+        dropRankDirectory();
+        copyHash(source);
+        return *this;
+    }
+    dropSparse();
+
+    //heap words are shared, not copied; they are copied on the first change
+    if (source.isSharable())
+    {
+        shareWords(source.arraySet);
+        releaseWords();
+        arraySet = source.arraySet;
+        capacity = source.capacity;
+        size = source.size;
+        population = source.population;
+        dropRankDirectory();
+        copyHash(source);
+        return *this;
+    }
+
+    //make room for the source's words (reusing the buffer if it is enough)
+    allocate(source.getSize());
+
+    //copy word by word
+    for (int i = 0; i < wordCount(); i++)
+    {
+        arraySet[i] = source.arraySet[i];
+    }
+    population = source.population;
+    copyHash(source);
+
+    //return this int set
+    return *this;
+}
+
+//---------------------------------------------------------------------------
+
+IntSet& IntSet::operator=(IntSet&& source) noexcept
+{
+    //check whether source is being assigned to itself
+    if (this == &source)
+    {
+        return *this;
+    }
+
+    //release this int set's words and take over the source's
+    releaseWords();
+    dropSparse();
+    takeWords(source);
+
+    return *this;
+}
+
+//---------------------------------------------------------------------------
+
+IntSet& IntSet::operator+=(const IntSet& other)
+{
+    makeWritable();
+
+    //grow only when the other set can hold larger values
+    if (other.getSize() > size)
+    {
+        extend(other.getSize(), std::max(population, other.population));
+    }
+
+    //this set in sparse mode: merge chunk by chunk
+    if (sparse != nullptr)
+    {
+        combineChunks(other, &SparseIntSet::operator+=, size);
+        return *this;
+    }
+
+    //the other set in sparse mode: set the bits of its words with members
+    if (other.sparse != nullptr)
+    {
+        uint64_t bits = 0;
+        for (int i = other.nextWord(0, bits); i != -1;
+            i = other.nextWord(i + 1, bits))
+        {
+            population += popcount64(bits & ~arraySet[i]);
+            arraySet[i] |= bits;
+        }
+        return *this;
+    }
+
+    //merge the other set's words into this one in place
+    return copy(other, this);
+}
+
+//---------------------------------------------------------------------------
+
+IntSet& IntSet::operator*=(const IntSet& other)
+{
+    makeWritable();
+
+    //the intersection can only hold values both sets can hold
+    int minSize = min(size, other.getSize());
+
+    //this set in sparse mode: intersect chunk by chunk
+    if (sparse != nullptr)
+    {
+        combineChunks(other, &SparseIntSet::operator*=, minSize);
+        return *this;
+    }
+
+    //keep only the bits that exist in both int sets, in place (the words
+    //of a sparse set are looked up in its chunks)
+    int minWords = wordsFor(minSize);
+    if (other.sparse != nullptr)
+    {
+        population = 0;
+        for (int i = 0; i < minWords; i++)
+        {
+            arraySet[i] &= (arraySet[i] != 0) ? other.wordAt(i) : 0;
+            population += popcount64(arraySet[i]);
+        }
+    }
+    else
+    {
+        population = applyWords(kernels().andWords, arraySet, arraySet,
+            other.arraySet, minWords);
+    }
+
+    //clear the words past the new size so the spare capacity stays empty
+    for (int i = minWords; i < wordCount(); i++)
+    {
+        arraySet[i] = 0;
+    }
+
+    size = minSize;
+    return *this;
+}
+
+//---------------------------------------------------------------------------
+
+IntSet& IntSet::operator-=(const IntSet& other)
+{
+    makeWritable();
+
+    //this set in sparse mode: subtract chunk by chunk
+    if (sparse != nullptr)
+    {
+        combineChunks(other, &SparseIntSet::operator-=, size);
+        return *this;
+    }
+
+    //the other set in sparse mode: clear the bits of its words with members
+    if (other.sparse != nullptr)
+    {
+        uint64_t bits = 0;
+        for (int i = other.nextWord(0, bits); i != -1 && i < wordCount();
+            i = other.nextWord(i + 1, bits))
+        {
+            population -= popcount64(bits & arraySet[i]);
+            arraySet[i] &= ~bits;
+        }
+        return *this;
+    }
+
+    //drop the bits that also occur in the other set, in place
+    int sharedWords = min(wordCount(), other.wordCount());
+    population = applyWords(kernels().andNotWords, arraySet, arraySet,
+        other.arraySet, sharedWords);
+
+    //words past the end of the other set are unchanged
+    population += countWords(arraySet + sharedWords, wordCount() - sharedWords);
+    return *this;
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::operator==(const IntSet& other) const
+{
+    //check whether the memory locations are equal
+    if (this == &other)
+    {
+        return true;
+    }
+
+    //sets that contain each other have the same size and the same words,
+    //so the same number of members and (once computed) the same hash
+    if (size != other.getSize() || population != other.population)
+    {
+        return false;
+    }
+    if (hashValid.load(memory_order_acquire) &&
+        other.hashValid.load(memory_order_acquire) &&
+        hashValue.load(memory_order_relaxed) !=
+        other.hashValue.load(memory_order_relaxed))
+    {
+        return false;
+    }
+
+    if (sparse == nullptr && other.sparse == nullptr)
+    {
+        return testWords(kernels().equalWords, arraySet, other.arraySet,
+            wordCount());
+    }
+    if (sparse != nullptr && other.sparse != nullptr)
+    {
+        return *sparse == *other.sparse;
+    }
+
+    //one set in sparse mode: its words with members must match the other's
+    //(with equal counts, the other then has no members anywhere else)
+    const IntSet& chunked = (sparse != nullptr) ? *this : other;
+    const IntSet& dense = (sparse != nullptr) ? other : *this;
+    uint64_t bits = 0;
+    for (int i = chunked.nextWord(0, bits); i != -1;
+        i = chunked.nextWord(i + 1, bits))
+    {
+        if (dense.arraySet[i] != bits)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------
+
+size_t IntSet::hash() const
+{
+    //the acquire pairs with the release below, so a valid flag is never
+    //seen before the value it guards
+    if (hashValid.load(memory_order_acquire))
+    {
+        return hashValue.load(memory_order_relaxed);
+    }
+
+    //mix the bits and position of each word holding members into the
+    //running value; empty words are skipped, so sets with the same members
+    //hash alike whatever their size, capacity or mode
+    uint64_t h = 0x9E3779B97F4A7C15ULL;
+    uint64_t bits = 0;
+    for (int i = nextWord(0, bits); i != -1; i = nextWord(i + 1, bits))
+    {
+        uint64_t x = bits + 0x9E3779B97F4A7C15ULL * (i + 1);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        h = (h ^ x ^ (x >> 31)) * 0x100000001B3ULL;
+    }
+
+    //threads racing to fill the cache all store the same value
+    size_t result = (size_t)(h ^ (h >> 32));
+    hashValue.store(result, memory_order_relaxed);
+    hashValid.store(true, memory_order_release);
+    return result;
+}
+
+//---------------------------------------------------------------------------
+
+void IntSet::copyHash(const IntSet& source)
+{
+    //read the flag first: a value read after a valid flag is the right one
+    bool valid = source.hashValid.load(memory_order_acquire);
+    hashValue.store(source.hashValue.load(memory_order_relaxed),
+        memory_order_relaxed);
+    hashValid.store(valid, memory_order_relaxed);
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::operator!=(const IntSet& other) const
+{
+    return !(*this == other);
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::insert(int x)
+{
+    //check whether int is within range
+    if (isWithinRange(x))
+    {
+        //sparse mode: add the value to its chunk, counting it if it is new
+        if (sparse != nullptr)
+        {
+            if (!sparse->isInSet(x))
+            {
+                makeWritable();
+                sparse->insert(x);
+                population++;
+                settle();
+            }
+            return true;
+        }
+
+        //set the bit for the given value, counting it if it is new
+        uint64_t bit = uint64_t(1) << (x % WORD_BITS);
+        if ((arraySet[x / WORD_BITS] & bit) == 0)
+        {
+            makeWritable();
+            arraySet[x / WORD_BITS] |= bit;
+            population++;
+        }
+        return true;
+    }
+
+    //check whether int exceeds limits (the range must still fit an int)
+    else if (x >= size && x <= MAX_VALUE)
+    {
+        //extend the range to hold (x + 1) values, then set the bit (or add
+        //the value to its chunk, if the set is now in sparse mode)
+        makeWritable();
+        extend(x + 1, population + 1);
+        if (sparse != nullptr)
+        {
+            sparse->insert(x);
+        }
+        else
+        {
+            arraySet[x / WORD_BITS] |= uint64_t(1) << (x % WORD_BITS);
+        }
+        population++;
+        return true;
+    }
+
+    //int argument might be negative or invalid
+    return false;
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::remove(int x)
+{
+    //check whether array contains elements and given index is in set
+    if (!isEmpty() && isInSet(x))
+    {
+        //remove element
+        makeWritable();
+        if (sparse != nullptr)
+        {
+            sparse->remove(x);
+        }
+        else
+        {
+            arraySet[x / WORD_BITS] &= ~(uint64_t(1) << (x % WORD_BITS));
+        }
+        population--;
+        return true;
+    }
+
+    //array is empty, or the value does not exist within set
+    return false;
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::insertRange(int lo, int hi)
+{
+    if (lo < 0 || hi < lo)
+    {
+        return false;
+    }
+    if (lo == hi)
+    {
+        return true;
+    }
+
+    //extend the range once (the range's values count as members)
+    makeWritable();
+    if (hi > size)
+    {
+        extend(hi, std::max(population, hi - lo));
+    }
+    else if (sparse != nullptr && prefersWords(wordCount(), hi - lo))
+    {
+        makeDense();
+    }
+
+    //sparse mode: set the values a chunk at a time
+    if (sparse != nullptr)
+    {
+        sparse->insertRange(lo, hi);
+        population = sparse->count();
+        settle();
+        return true;
+    }
+
+    //set the bits a whole word at a time
+    for (int i = lo / WORD_BITS; i <= (hi - 1) / WORD_BITS; i++)
+    {
+        uint64_t mask = rangeMask(i, lo, hi);
+        population += popcount64(mask & ~arraySet[i]);
+        arraySet[i] |= mask;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::removeRange(int lo, int hi)
+{
+    //only values the set can hold can be removed
+    lo = std::max(lo, 0);
+    hi = min(hi, size);
+    if (lo >= hi || isEmpty())
+    {
+        return false;
+    }
+
+    //sparse mode: clear the values a chunk at a time
+    makeWritable();
+    if (sparse != nullptr)
+    {
+        bool removed = sparse->removeRange(lo, hi);
+        population = sparse->count();
+        return removed;
+    }
+
+    //clear the bits a whole word at a time
+    int removed = 0;
+    for (int i = lo / WORD_BITS; i <= (hi - 1) / WORD_BITS; i++)
+    {
+        uint64_t mask = rangeMask(i, lo, hi);
+        removed += popcount64(mask & arraySet[i]);
+        arraySet[i] &= ~mask;
+    }
+    population -= removed;
+    return removed > 0;
+}
+
+//---------------------------------------------------------------------------
+
+uint64_t IntSet::rangeMask(int word, int lo, int hi)
+{
+    //all bits, minus those below lo in lo's word and from hi in hi's word
+    uint64_t mask = ~uint64_t(0);
+    if (word == lo / WORD_BITS)
+    {
+        mask &= ~uint64_t(0) << (lo % WORD_BITS);
+    }
+    if (word == (hi - 1) / WORD_BITS)
+    {
+        mask &= ~uint64_t(0) >> (WORD_BITS - 1 - (hi - 1) % WORD_BITS);
+    }
+    return mask;
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::isEmpty() const
+{
+    return population == 0;
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::isInSet(int x) const
+{
+    //must be within the range of the set, and the given bit must be set
+    //(or, in sparse mode, the value must be in its chunk)
+    if (!isWithinRange(x))
+    {
+        return false;
+    }
+    if (sparse != nullptr)
+    {
+        return sparse->isInSet(x);
+    }
+    return ((arraySet[x / WORD_BITS] >> (x % WORD_BITS)) & 1) != 0;
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::containsSet(const IntSet& subset) const
+{
+    //set cannot contain a larger set
+    if (size < subset.getSize())
+    {
+        return false;
+    }
+
+    //contained only if no bit in the subset is missing from the superset
+    if (sparse == nullptr && subset.sparse == nullptr)
+    {
+        return testWords(kernels().subsetWords, subset.arraySet, arraySet,
+            subset.wordCount());
+    }
+    if (sparse != nullptr && subset.sparse != nullptr)
+    {
+        return sparse->containsSet(*subset.sparse);
+    }
+
+    //one set in sparse mode: check the subset's words with members
+    uint64_t bits = 0;
+    for (int i = subset.nextWord(0, bits); i != -1;
+        i = subset.nextWord(i + 1, bits))
+    {
+        if ((bits & ~wordAt(i)) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------
+
+int IntSet::intersectionCount(const IntSet& other) const
+{
+    //either set in sparse mode: walk the words with members of the one with
+    //fewer members, and look each up in the other
+    if (sparse != nullptr || other.sparse != nullptr)
+    {
+        const IntSet& fewer = (population <= other.population) ? *this : other;
+        const IntSet& more = (population <= other.population) ? other : *this;
+        int count = 0;
+        uint64_t bits = 0;
+        for (int i = fewer.nextWord(0, bits); i != -1;
+            i = fewer.nextWord(i + 1, bits))
+        {
+            count += popcount64(bits & more.wordAt(i));
+        }
+        return count;
+    }
+
+    //count the bits set in both, word by word, without storing them
+    int sharedWords = min(wordCount(), other.wordCount());
+    return countPairWords(kernels().andCountWords, arraySet, other.arraySet,
+        sharedWords);
+}
+
+//---------------------------------------------------------------------------
+
+int IntSet::unionCount(const IntSet& other) const
+{
+    //members of either set, counting the shared ones once
+    return population + other.population - intersectionCount(other);
+}
+
+//---------------------------------------------------------------------------
+
+int IntSet::differenceCount(const IntSet& other) const
+{
+    //members of this set that the other does not hold
+    return population - intersectionCount(other);
+}
+
+//---------------------------------------------------------------------------
+
+double IntSet::jaccard(const IntSet& other) const
+{
+    //two empty sets are taken to be identical
+    int shared = intersectionCount(other);
+    int either = population + other.population - shared;
+    return (either == 0) ? 1.0 : (double)shared / either;
+}
+
+//---------------------------------------------------------------------------
+
+IntSet IntSet::unionAll(const IntSet* const* sets, int count)
+{
+    //the union can hold every value any of the sets can hold
+    int maxSize = 0;
+    bool anySparse = false;
+    for (int s = 0; s < count; s++)
+    {
+        maxSize = std::max(maxSize, sets[s]->getSize());
+        anySparse = anySparse || sets[s]->sparse != nullptr;
+    }
+
+    //sets in sparse mode have no words to sweep: merge one set at a time
+    IntSet result;
+    if (anySparse)
+    {
+        for (int s = 0; s < count; s++)
+        {
+            result += *sets[s];
+        }
+        return result;
+    }
+
+    result.allocate(maxSize);
+
+    //merge one block of words from every set while the block is in cache
+    int words = result.wordCount();
+    for (int start = 0; start < words; start += SWEEP_WORDS)
+    {
+        int end = min(words, start + SWEEP_WORDS);
+        for (int s = 0; s < count; s++)
+        {
+            int setEnd = min(end, sets[s]->wordCount());
+            if (setEnd > start)
+            {
+                kernels().orWords(result.arraySet + start,
+                    result.arraySet + start, sets[s]->arraySet + start,
+                    setEnd - start);
+            }
+        }
+        result.population += countWords(result.arraySet + start,
+            end - start);
+    }
+
+    return result;
+}
+
+//---------------------------------------------------------------------------
+
+IntSet IntSet::intersectAll(const IntSet* const* sets, int count)
+{
+    //the intersection can only hold values every set can hold
+    int minSize = (count > 0) ? INT_MAX : 0;
+    bool anySparse = false;
+    for (int s = 0; s < count; s++)
+    {
+        //an empty set empties the whole intersection
+        if (sets[s]->isEmpty())
+        {
+            minSize = 0;
+            break;
+        }
+        minSize = min(minSize, sets[s]->getSize());
+        anySparse = anySparse || sets[s]->sparse != nullptr;
+    }
+
+    //sets in sparse mode have no words to sweep: narrow one set at a time
+    if (minSize > 0 && anySparse)
+    {
+        IntSet result(*sets[0]);
+        for (int s = 1; s < count; s++)
+        {
+            result *= *sets[s];
+        }
+        return result;
+    }
+
+    IntSet result;
+    result.allocate(minSize);
+
+    //start each block from the first set, then narrow it by the others
+    //while it is in cache, stopping once nothing is left in the block
+    int words = result.wordCount();
+    for (int start = 0; start < words; start += SWEEP_WORDS)
+    {
+        int length = min(words, start + SWEEP_WORDS) - start;
+        int blockCount = countWords(sets[0]->arraySet + start, length);
+        for (int i = 0; i < length; i++)
+        {
+            result.arraySet[start + i] = sets[0]->arraySet[start + i];
+        }
+
+        for (int s = 1; s < count && blockCount > 0; s++)
+        {
+            blockCount = kernels().andWords(result.arraySet + start,
+                result.arraySet + start, sets[s]->arraySet + start, length);
+        }
+        result.population += blockCount;
+    }
+
+    return result;
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::operator[] (int x) const
+{
+    //return element if it is in the set.
+    return isInSet(x);
+}
+
+//---------------------------------------------------------------------------
+
+int IntSet::getSize() const
+{
+    return size;
+}
+
+//---------------------------------------------------------------------------
+
+int IntSet::count() const
+{
+    return population;
+}
+
+//---------------------------------------------------------------------------
+
+int IntSet::rank(int x) const
+{
+    //every member is at least 0 and below the size
+    if (x <= 0)
+    {
+        return 0;
+    }
+    if (x >= size)
+    {
+        return population;
+    }
+    if (sparse != nullptr)
+    {
+        return sparse->rank(x);
+    }
+
+    //members before x's block, then the whole words of the block before x
+    int wordIndex = x / WORD_BITS;
+    int block = wordIndex / RANK_BLOCK_WORDS;
+    const int* directory = buildRankDirectory();
+    int count = directory[block];
+    for (int i = block * RANK_BLOCK_WORDS; i < wordIndex; i++)
+    {
+        count += popcount64(arraySet[i]);
+    }
+
+    //and the bits below x in its own word
+    uint64_t below = (uint64_t(1) << (x % WORD_BITS)) - 1;
+    return count + popcount64(arraySet[wordIndex] & below);
+}
+
+//---------------------------------------------------------------------------
+
+int IntSet::select(int k) const
+{
+    if (k < 0 || k >= population)
+    {
+        return -1;
+    }
+    if (sparse != nullptr)
+    {
+        return sparse->select(k);
+    }
+
+    //last block with at most k members before it
+    const int* directory = buildRankDirectory();
+    int blocks = (wordCount() + RANK_BLOCK_WORDS - 1) / RANK_BLOCK_WORDS;
+    int block = (int)(upper_bound(directory, directory + blocks, k) -
+        directory) - 1;
+
+    //walk the words of that block to the one holding the member
+    int remaining = k - directory[block];
+    for (int i = block * RANK_BLOCK_WORDS; i < wordCount(); i++)
+    {
+        int bits = popcount64(arraySet[i]);
+        if (remaining < bits)
+        {
+            return i * WORD_BITS + select64(arraySet[i], remaining);
+        }
+        remaining -= bits;
+    }
+
+    //unreachable while population matches the words
+    return -1;
+}
+
+//---------------------------------------------------------------------------
+
+const int* IntSet::buildRankDirectory() const
+{
+    //already built: the acquire makes its counts visible with the pointer
+    int* directory = rankDirectory.load(memory_order_acquire);
+    if (directory != nullptr)
+    {
+        return directory;
+    }
+
+    //one running total per block, taken before the block's words
+    int blocks = (wordCount() + RANK_BLOCK_WORDS - 1) / RANK_BLOCK_WORDS;
+    int* built = new int[blocks];
+    int count = 0;
+    for (int block = 0; block < blocks; block++)
+    {
+        built[block] = count;
+        int end = min(wordCount(), (block + 1) * RANK_BLOCK_WORDS);
+        count += countWords(arraySet + block * RANK_BLOCK_WORDS,
+            end - block * RANK_BLOCK_WORDS);
+    }
+
+    //publish it; if another thread published first, use that one instead
+    if (rankDirectory.compare_exchange_strong(directory, built,
+        memory_order_acq_rel, memory_order_acquire))
+    {
+        return built;
+    }
+    delete[] built;
+    return directory;
+}
+
+//---------------------------------------------------------------------------
+
+void IntSet::dropRankDirectory()
+{
+    //a relaxed check keeps this cheap on every change to the set
+    int* directory = rankDirectory.load(memory_order_relaxed);
+    if (directory != nullptr)
+    {
+        rankDirectory.store(nullptr, memory_order_relaxed);
+        delete[] directory;
+    }
+}
+
+//---------------------------------------------------------------------------
+
+IntSet::Iterator IntSet::begin() const
+{
+    return (sparse != nullptr) ? Iterator(sparse) :
+        Iterator(arraySet, wordCount());
+}
+
+//---------------------------------------------------------------------------
+
+IntSet::Iterator IntSet::end() const
+{
+    return Iterator();
+}
+
+//---------------------------------------------------------------------------
+
+IntSet& IntSet::copy(const IntSet& source, IntSet* dest)
+{
+    //have a variable for the source word count
+    int sourceWords = source.wordCount();
+
+    //merge words block by block from source into dest
+    dest->population = applyWords(kernels().orWords, dest->arraySet,
+        dest->arraySet, source.arraySet, sourceWords);
 
-    //attempt to insert each of the arguments
-    insert(a);
-    insert(b);
-    insert(c);
-    insert(d);
-    insert(e);
+    //words past the end of the source are unchanged
+    dest->population += countWords(dest->arraySet + sourceWords,
+        dest->wordCount() - sourceWords);
+
+    //return reference to modified int set
+    return *dest;
 }
 
 //---------------------------------------------------------------------------
-IntSet::IntSet(const IntSet& source)
+
+bool IntSet::isWithinRange(int x) const
+{
+    //value must be an integer between 0 (included) and the size (excluded)
+    return x >= 0 && x < size;
+}
+
+//---------------------------------------------------------------------------
+
+void IntSet::allocate(int values)
 {
-    //create a new array with same size as the source
-    int size = source.getSize();
-    arraySet = new bool[size];
+    int newWords = wordsFor(values);
+    dropSparse();
+    dropRankDirectory();
+    hashValid.store(false, memory_order_relaxed);
+
+    //reuse the current buffer when it is large enough (and writable)
+    if (newWords <= capacity && mapping == nullptr && !isShared())
+    {
+        //clear the words in use; spare capacity is already empty
+        for (int i = 0; i < wordCount(); i++)
+        {
+            arraySet[i] = 0;
+        }
+        size = values;
+        population = 0;
+        return;
+    }
+
+    //release the current words
+    releaseWords();
+    size = values;
+    population = 0;
 
-    //initialize all values to false (empty set)
-    for (int i = 0; i < size; i++)
+    //small sets go back to the inline words
+    if (newWords <= INLINE_WORDS)
     {
-        arraySet[i] = false;
+        useInlineWords();
+        return;
     }
 
-    //call the assignment operator
-    *this = source;
+    //create a zeroed word array able to hold the given number of values
+    capacity = newWords;
+    arraySet = newWordBuffer(capacity);
+    for (int i = 0; i < capacity; i++)
+    {
+        arraySet[i] = 0;
+    }
 }
 
 //---------------------------------------------------------------------------
 
-IntSet::~IntSet()
+void IntSet::grow(int values)
 {
-    delete[] arraySet;
-    arraySet = nullptr;
-    size = 0;
+    //reallocate geometrically so a run of inserts costs amortized O(1)
+    int newWords = wordsFor(values);
+    if (newWords > capacity)
+    {
+        reallocate(std::max(newWords, 2 * capacity));
+    }
+
+    //the spare words are already empty, so only the range changes
+    size = values;
 }
 
 //---------------------------------------------------------------------------
 
-IntSet& IntSet::operator=(const IntSet& source)
+void IntSet::extend(int values, int members)
 {
-    //check whether source is being assigned to itself
-    if (this == &source)
-    {
-        return *this;
-    }
+    int newWords = wordsFor(values);
 
-    //nullify the array set pointer
-    if (arraySet != nullptr)
+    //sparse mode: only the range changes, unless the members would now
+    //fill the words
+    if (sparse != nullptr)
     {
-        delete[] arraySet;
-        arraySet = nullptr;
-        size = 0;
+        size = values;
+        if (prefersWords(newWords, members))
+        {
+            makeDense();
+        }
+        return;
     }
-    
-    //allocate array to be equal size of source 
-    int sourceSize = source.getSize();
-    size = sourceSize;
-    arraySet = new bool[size];
 
-    //copy element by element
-    for (int i = 0; i < sourceSize; i++)
+    //words that would be mostly empty: keep the members in chunks instead
+    //(words already reserved are used as they are)
+    if (newWords > capacity && prefersSparse(newWords, members))
     {
-        arraySet[i] = source[i];
+        makeSparse();
+        size = values;
+        return;
     }
 
-    //return this int set
-    return *this;
+    grow(values);
 }
 
 //---------------------------------------------------------------------------
 
-IntSet& IntSet::operator+=(const IntSet& other)
+bool IntSet::prefersSparse(int words, int members)
 {
-    *this = *this + other;
-    return *this;
+    //fewer members than words: chunks take at most a quarter of the bytes
+    return words > SPARSE_MIN_WORDS && members < words;
 }
 
 //---------------------------------------------------------------------------
 
-IntSet& IntSet::operator*=(const IntSet& other)
+bool IntSet::prefersWords(int words, int members)
 {
-    *this = (*this) * other;
-    return *this;
+    //at this many members, the chunks are no smaller than the words
+    return words <= SPARSE_MIN_WORDS ||
+        members >= DENSE_MEMBERS_PER_WORD * words;
 }
 
 //---------------------------------------------------------------------------
 
-IntSet& IntSet::operator-=(const IntSet& other)
+void IntSet::makeSparse()
 {
-    *this = (*this) - other;
-    return *this;
+    //copy the members into chunks, then let go of the words; the rank
+    //directory counts words, so it goes too (the hash stays valid)
+    SparseIntSet* chunks = new SparseIntSet();
+    chunks->assignWords(arraySet, wordCount());
+    releaseWords();
+    useInlineWords();
+    dropRankDirectory();
+    sparse = chunks;
 }
 
 //---------------------------------------------------------------------------
 
-bool IntSet::operator==(const IntSet& other) const
+void IntSet::makeDense()
 {
-    //check whether the memory locations are equal
-    if (this == &other)
+    //allocate empty words for the range (the size is cleared first, since
+    //there are no words in use to clear yet), then copy each word with
+    //members out of the chunks
+    SparseIntSet* chunks = sparse;
+    int values = size;
+    int members = population;
+    sparse = nullptr;
+    size = 0;
+    allocate(values);
+
+    uint64_t bits = 0;
+    for (int i = chunks->nextWord(0, bits); i != -1;
+        i = chunks->nextWord(i + 1, bits))
     {
-        return true;
+        arraySet[i] = bits;
     }
+    population = members;
+    delete chunks;
+}
+
+//---------------------------------------------------------------------------
 
-    //check whether both intsets contain each other. Contents are equal then
-    if (this->containsSet(other) && other.containsSet(*this))
+void IntSet::settle()
+{
+    if (sparse != nullptr && prefersWords(wordCount(), population))
     {
-        return true;
+        makeDense();
     }
+}
 
-    //anything else means that the sets are not equal
-    return false;
+//---------------------------------------------------------------------------
+
+void IntSet::dropSparse()
+{
+    //the inline words are kept clear in sparse mode, so the set is left
+    //empty on them
+    if (sparse != nullptr)
+    {
+        delete sparse;
+        sparse = nullptr;
+        size = 0;
+        population = 0;
+    }
 }
 
 //---------------------------------------------------------------------------
 
-bool IntSet::operator!=(const IntSet& other) const
+void IntSet::combineChunks(const IntSet& other,
+    SparseIntSet& (SparseIntSet::*apply)(const SparseIntSet&), int newSize)
 {
-    return !(*this == other);
+    //a set with words is copied into chunks for the operator
+    SparseIntSet converted;
+    if (other.sparse == nullptr)
+    {
+        converted.assignWords(other.arraySet, other.wordCount());
+    }
+    (sparse->*apply)((other.sparse != nullptr) ? *other.sparse : converted);
+
+    size = newSize;
+    population = sparse->count();
+    settle();
 }
 
 //---------------------------------------------------------------------------
 
-bool IntSet::insert(int x)
+uint64_t IntSet::wordAt(int i) const
 {
-    //check whether int is within range
-    if (isWithinRange(x))          
+    if (sparse != nullptr)
     {
-        //set given index to true
-        arraySet[x] = true;
-        return true;
+        return sparse->word(i);
     }
+    return word(i);
+}
+
+//---------------------------------------------------------------------------
 
-    //check whether int exceeds limits
-    else if (x >= size)      
+int IntSet::nextWord(int i, uint64_t& bits) const
+{
+    if (sparse != nullptr)
     {
-        //create a new array with size (x + 1)
-        bool* newArraySet = new bool[x + 1];
+        return sparse->nextWord(i, bits);
+    }
 
-        //copy values from existing array into new array 
-        for (int i = 0; i < size; i++)
+    //skip the empty words
+    for (; i < wordCount(); i++)
+    {
+        if (arraySet[i] != 0)
         {
-            newArraySet[i] = arraySet[i];
+            bits = arraySet[i];
+            return i;
         }
+    }
+    return -1;
+}
 
-        //copy new int into new array 
-        newArraySet[x] = true;
+//---------------------------------------------------------------------------
 
-        //deallocate memory; reassign array pointer and size
-        delete[] arraySet;
-        arraySet = newArraySet;
-        size += (x + 1 - size);
-        return true;
+void IntSet::reallocate(int words)
+{
+    //the inline words are already the smallest buffer a set can have
+    bool toInline = words <= INLINE_WORDS;
+    if (toInline && arraySet == inlineWords)
+    {
+        return;
     }
 
-    //int argument might be negative or invalid
-    return false;   
+    //create a new word array with the given capacity (or use the inline
+    //words, which are free while the set lives elsewhere)
+    words = toInline ? INLINE_WORDS : words;
+    int keptWords = min(wordCount(), words);
+    uint64_t* newArraySet = toInline ? inlineWords : newWordBuffer(words);
+
+    //copy words from existing array into new array
+    for (int i = 0; i < keptWords; i++)
+    {
+        newArraySet[i] = arraySet[i];
+    }
+
+    //clear the words that were added
+    for (int i = keptWords; i < words; i++)
+    {
+        newArraySet[i] = 0;
+    }
+
+    //deallocate memory; reassign array pointer and capacity
+    releaseWords();
+    arraySet = newArraySet;
+    capacity = words;
 }
 
 //---------------------------------------------------------------------------
 
-bool IntSet::remove(int x)
+void IntSet::reserve(int maxValue)
 {
-    //check whether array contains elements and given index is in set
-    if (!isEmpty() && isInSet(x))
+    //make room for values up to maxValue without changing the set's range
+    int words = wordsFor((maxValue < MAX_VALUE ? maxValue : MAX_VALUE) + 1);
+    if (maxValue >= 0 && words > capacity && sparse == nullptr)
     {
-        //remove element
-        arraySet[x] = false;
-        return true;
+        reallocate(words);
     }
-
-    //array is empty, or the value does not exist within set
-    return false;
 }
 
 //---------------------------------------------------------------------------
 
-bool IntSet::isEmpty() const
+void IntSet::shrinkToFit()
 {
-    return size == 0;
+    //release any words past the ones the current range needs
+    if (capacity > wordCount() && sparse == nullptr)
+    {
+        reallocate(wordCount());
+    }
 }
 
 //---------------------------------------------------------------------------
 
-bool IntSet::isInSet(int x) const
+int IntSet::getCapacity() const
 {
-    //must be within the range of the set, and the given index must be true
-    return isWithinRange(x) && arraySet[x];
+    //number of values that can be held before the words are reallocated
+    //(a sparse set has no spare words)
+    if (sparse != nullptr)
+    {
+        return size;
+    }
+    return (capacity > INT_MAX / WORD_BITS) ? INT_MAX : capacity * WORD_BITS;
 }
 
 //---------------------------------------------------------------------------
 
-bool IntSet::containsSet(const IntSet& subset) const
+bool IntSet::saveSnapshot(const char* path) const
 {
-    //set cannot contain a larger set
-    if (size < subset.getSize())
+    //describe the words that follow
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.headerBytes = sizeof(SnapshotHeader);
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.size = size;
+    header.population = population;
+    header.words = wordCount();
+
+    //write the header and the words in use as they are
+    ofstream file(path, ios::binary | ios::trunc);
+    file.write((const char*)&header, sizeof(header));
+    if (sparse == nullptr)
     {
-        return false;
+        file.write((const char*)arraySet, (streamsize)wordCount() *
+            sizeof(uint64_t));
     }
-    
-    //iterate through this set
-    for (int i = 0; i < size; i++)
+
+    //sparse mode: lay the chunks out as words, one block at a time
+    else
     {
-        //not contained: an element in the subset is not within the superset
-        if (!arraySet[i] && subset[i])
+        uint64_t block[SNAPSHOT_BLOCK_WORDS];
+        uint64_t bits = 0;
+        int next = sparse->nextWord(0, bits);
+        for (int start = 0; start < wordCount();
+            start += SNAPSHOT_BLOCK_WORDS)
         {
-            return false;
+            int length = (wordCount() - start < SNAPSHOT_BLOCK_WORDS) ?
+                wordCount() - start : SNAPSHOT_BLOCK_WORDS;
+            fill(block, block + length, uint64_t(0));
+            while (next != -1 && next < start + length)
+            {
+                block[next - start] = bits;
+                next = sparse->nextWord(next + 1, bits);
+            }
+            file.write((const char*)block, (streamsize)length *
+                sizeof(uint64_t));
         }
     }
+    file.close();
+    return !file.fail();
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::mapSnapshot(const char* path)
+{
+    size_t bytes = 0;
+    void* base = mapFile(path, bytes);
+    if (base == nullptr)
+    {
+        return false;
+    }
+
+    //check the header against this format and the length of the file
+    const SnapshotHeader* header = (const SnapshotHeader*)base;
+    const uint64_t* words = (const uint64_t*)(header + 1);
+    bool valid = bytes >= sizeof(SnapshotHeader) &&
+        memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) == 0 &&
+        header->version == SNAPSHOT_VERSION &&
+        header->headerBytes == sizeof(SnapshotHeader) &&
+        header->byteOrder == SNAPSHOT_BYTE_ORDER &&
+        header->size >= 0 && header->size <= INT_MAX - WORD_BITS &&
+        header->words == (header->size + WORD_BITS - 1) / WORD_BITS &&
+        header->population >= 0 && header->population <= header->size &&
+        bytes == sizeof(SnapshotHeader) + header->words * sizeof(uint64_t);
+
+    //bits past the size must be clear, as in any IntSet
+    if (valid && header->size % WORD_BITS != 0)
+    {
+        valid = (words[header->words - 1] >> (header->size % WORD_BITS)) == 0;
+    }
+
+    if (!valid)
+    {
+        unmapFile(base, bytes);
+        return false;
+    }
 
-    //contains subset: all elements in the subset are within the superset
+    //use the mapped words in place of this set's own
+    releaseWords();
+    dropSparse();
+    dropRankDirectory();
+    hashValid.store(false, memory_order_relaxed);
+    mapping = base;
+    mappingBytes = bytes;
+    arraySet = const_cast<uint64_t*>(words);
+    size = (int)header->size;
+    capacity = (int)header->words;
+    population = (int)header->population;
     return true;
 }
 
 //---------------------------------------------------------------------------
 
-bool IntSet::operator[] (int x) const
+bool IntSet::isMapped() const
 {
-    //return element if it is in the set.
-    if (isWithinRange(x))
+    return mapping != nullptr;
+}
+
+//---------------------------------------------------------------------------
+
+bool IntSet::isSparse() const
+{
+    return sparse != nullptr;
+}
+
+//---------------------------------------------------------------------------
+
+void IntSet::releaseWords()
+{
+    //mapped words belong to the snapshot file; inline words to the object;
+    //heap words to every set sharing them
+    if (mapping != nullptr)
     {
-        return arraySet[x];
+        unmapFile(mapping, mappingBytes);
     }
-    
-    //element is not in the set
-    return false;
+    else if (arraySet != inlineWords)
+    {
+        freeWordBuffer(arraySet);
+    }
+
+    //the inline words are not cleared here: callers refill or replace them
+    arraySet = inlineWords;
+    capacity = INLINE_WORDS;
+    mapping = nullptr;
+    mappingBytes = 0;
 }
 
 //---------------------------------------------------------------------------
 
-int IntSet::getSize() const
+void IntSet::useInlineWords()
 {
-    return size;
+    arraySet = inlineWords;
+    capacity = INLINE_WORDS;
+    for (int i = 0; i < INLINE_WORDS; i++)
+    {
+        inlineWords[i] = 0;
+    }
 }
 
 //---------------------------------------------------------------------------
 
-IntSet& IntSet::copy(const IntSet& source, IntSet* dest)
+void IntSet::takeWords(IntSet& source)
 {
-    //have a variable for the source size
-    int sourceSize = source.getSize();
-
-    //copy elements one by one from source to dest
-    for (int i = 0; i < sourceSize; i++)
+    //inline words stay with their object, so they are copied instead
+    if (source.arraySet == source.inlineWords)
     {
-        // only copy if value is not already present in dest
-        if (!dest->arraySet[i] && source[i])
+        for (int i = 0; i < INLINE_WORDS; i++)
         {
-            dest->insert(i);
+            inlineWords[i] = source.inlineWords[i];
         }
+        arraySet = inlineWords;
+    }
+    else
+    {
+        arraySet = source.arraySet;
     }
+    size = source.size;
+    capacity = source.capacity;
+    population = source.population;
+    mapping = source.mapping;
+    mappingBytes = source.mappingBytes;
+    sparse = source.sparse;
+    dropRankDirectory();
+    rankDirectory.store(source.rankDirectory.load(memory_order_relaxed),
+        memory_order_relaxed);
+    source.rankDirectory.store(nullptr, memory_order_relaxed);
+    copyHash(source);
+
+    //leave the source as an empty set on its own inline words
+    source.useInlineWords();
+    source.size = 0;
+    source.population = 0;
+    source.mapping = nullptr;
+    source.mappingBytes = 0;
+    source.sparse = nullptr;
+    source.hashValid.store(false, memory_order_relaxed);
+}
 
-    //return reference to modified int set
-    return *dest;
+//---------------------------------------------------------------------------
+
+void IntSet::makeWritable()
+{
+    //any change makes the rank directory and the hash stale
+    dropRankDirectory();
+    hashValid.store(false, memory_order_relaxed);
+
+    //copying into a buffer of the same length releases the mapping
+    if (mapping != nullptr)
+    {
+        reallocate(wordCount());
+    }
+
+    //words shared with other sets are copied before they are changed
+    else if (isShared())
+    {
+        reallocate(capacity);
+    }
 }
 
 //---------------------------------------------------------------------------
+// Shared word buffers
+// Heap words are allocated with a reference count in the word just before
+// them. Copies of an IntSet share the buffer and bump the count; the count
+// is atomic, so copies of one set may be used from different threads.
+
+//references()
+//returns the reference count stored before a heap word buffer
+static atomic<uint64_t>& references(uint64_t* words)
+{
+    static_assert(sizeof(atomic<uint64_t>) == sizeof(uint64_t),
+        "the reference count must fit in one word");
+    return *reinterpret_cast<atomic<uint64_t>*>(words - 1);
+}
 
-bool IntSet::isWithinRange(int x) const
+//---------------------------------------------------------------------------
+
+uint64_t* IntSet::newWordBuffer(int words)
 {
-    //value must be an integer between 0 (included) and the size (excluded)
-    return x >= 0 && x < size;
+    //one extra word in front holds the reference count
+    uint64_t* block = new uint64_t[words + 1];
+    new (block) atomic<uint64_t>(1);
+    return block + 1;
+}
+
+//---------------------------------------------------------------------------
+
+void IntSet::freeWordBuffer(uint64_t* words)
+{
+    //the last set to let go of the words frees them
+    if (references(words).fetch_sub(1, memory_order_acq_rel) == 1)
+    {
+        delete[] (words - 1);
+    }
+}
+
+//---------------------------------------------------------------------------
+
+void IntSet::shareWords(uint64_t* words)
+{
+    references(words).fetch_add(1, memory_order_relaxed);
 }
 
 //---------------------------------------------------------------------------
 
-IntSet operator+(const IntSet& first, const IntSet& second)
+bool IntSet::isSharable() const
 {
-    //find larger of the two int sets
-    int firstSize = first.getSize();
-    int secondSize = second.getSize();
-    int retValSize = max(firstSize, secondSize);
+    //only heap words carry a reference count
+    return arraySet != inlineWords && mapping == nullptr;
+}
 
-    //create a pointer to an int set with this size
-    IntSet* retVal = new IntSet(retValSize - 1);
-    retVal->arraySet[retValSize - 1] = false;
+//---------------------------------------------------------------------------
 
-    //copy elements from first into retVal
-    retVal->copy(first, retVal);
+bool IntSet::isShared() const
+{
+    return isSharable() &&
+        references(arraySet).load(memory_order_acquire) > 1;
+}
 
-    //copy elements from second into retVal
-    retVal->copy(second, retVal);
-    
-    //save the IntSet in another variable, and delete the retVal pointer
-    IntSet rv = *retVal;
-    delete retVal;
-    retVal = nullptr;
+//---------------------------------------------------------------------------
 
-    //return IntSet
-    return rv;
+int IntSet::wordsFor(int values)
+{
+    //round up to the next whole word (adding WORD_BITS - 1 first would
+    //overflow for values near INT_MAX)
+    return values / WORD_BITS + (values % WORD_BITS != 0 ? 1 : 0);
 }
 
 //---------------------------------------------------------------------------
 
-IntSet operator*(const IntSet& first, const IntSet& second)
+int IntSet::wordCount() const
 {
-    //determine minimum of both IntSet sizes
-    int firstSize = first.getSize();
-    int secondSize = second.getSize();
-    int minSize = min(firstSize, secondSize);
+    return wordsFor(size);
+}
 
-    //create a pointer to a new int set with the minimum size
-    IntSet* retVal = new IntSet(minSize - 1);
-    retVal->arraySet[minSize - 1] = false;
+//---------------------------------------------------------------------------
 
-    //Fill in retVal
-    for (int i = 0; i < minSize; i++)
+int IntSet::UnionOp::fill(uint64_t* dest, const IntSet& first,
+    const IntSet& second)
+{
+    //merge the words both int sets have in one pass
+    int firstWords = first.wordCount();
+    int secondWords = second.wordCount();
+    int sharedWords = min(firstWords, secondWords);
+    int count = applyWords(kernels().orWords, dest, first.arraySet,
+        second.arraySet, sharedWords);
+
+    //copy the remaining words of the larger int set
+    const IntSet& larger = (firstWords > secondWords) ? first : second;
+    for (int i = sharedWords; i < larger.wordCount(); i++)
     {
-        //add element only if it exists in both int sets
-        if (first.isInSet(i) && second.isInSet(i))
-        {
-            retVal->insert(i);
-        }
-        else
-        {
-            //skip elements that are not in both sets
-            retVal->arraySet[i] = false;
-        }
+        dest[i] = larger.arraySet[i];
     }
+    return count + countWords(larger.arraySet + sharedWords,
+        larger.wordCount() - sharedWords);
+}
+
+//---------------------------------------------------------------------------
+
+int IntSet::IntersectionOp::fill(uint64_t* dest, const IntSet& first,
+    const IntSet& second)
+{
+    //keep only the bits that exist in both int sets
+    int minWords = min(first.wordCount(), second.wordCount());
+    return applyWords(kernels().andWords, dest, first.arraySet,
+        second.arraySet, minWords);
+}
 
-    //save the IntSet in another variable, and delete the retVal pointer
-    IntSet rv = *retVal;
-    delete retVal;
-    retVal = nullptr;
-    
-    //return IntSet 
-    return rv;
+//---------------------------------------------------------------------------
+
+int IntSet::DifferenceOp::fill(uint64_t* dest, const IntSet& first,
+    const IntSet& second)
+{
+    //drop bits that also occur in the second
+    int firstWords = first.wordCount();
+    int sharedWords = min(firstWords, second.wordCount());
+    int count = applyWords(kernels().andNotWords, dest, first.arraySet,
+        second.arraySet, sharedWords);
+
+    //words past the end of the second are kept as they are
+    for (int i = sharedWords; i < firstWords; i++)
+    {
+        dest[i] = first.arraySet[i];
+    }
+    return count + countWords(first.arraySet + sharedWords,
+        firstWords - sharedWords);
 }
 
 //---------------------------------------------------------------------------
 
-IntSet operator-(const IntSet& first, const IntSet& second)
+//text I/O goes through a local buffer of this many characters
+static const int TEXT_BUFFER = 1 << 14;
+
+//isBlank(), isDigit()
+//classify characters as the "C" locale does, without a library call
+static inline bool isBlank(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline bool isDigit(char c)
 {
-    //determine size of first and second array
-    int firstSize = first.getSize();
-    int secondSize = second.getSize();
+    return c >= '0' && c <= '9';
+}
 
-    //create a pointer to a new int set of the same size as first
-    IntSet* retVal = new IntSet(firstSize - 1);
-    retVal->arraySet[firstSize - 1] = false;
+//parseInt()
+//parses a whole token ("-12", "+7", "3") into x; false if it is not an int
+static bool parseInt(const char* first, const char* last, int& x)
+{
+    if (first != last && *first == '+')
+    {
+        first++;
+    }
+    from_chars_result result = from_chars(first, last, x);
+    return result.ec == errc() && result.ptr == last && first != last;
+}
 
-    //iterate through first array 
-    for (int i = 0; i < firstSize; i++)
+//putBack()
+//returns characters taken from the stream's current buffer to it
+static bool putBack(streambuf* buffer, const char* chars, int count)
+{
+    for (int i = count - 1; i >= 0; i--)
     {
-        //skip elements that do occur in the second or are not in the first
-        if ((i < secondSize && second[i]) || !first[i])
+        if (buffer->sputbackc(chars[i]) == char_traits<char>::eof())
         {
-            retVal->arraySet[i] = false;
-            continue;
+            return false;
         }
-
-        //insert elements that do not occur in second
-        retVal->insert(i);
     }
-    
-    //save the IntSet in another variable, and delete the retVal pointer
-    IntSet rv = *retVal;
-    delete retVal;
-    retVal = nullptr;
-
-    //return IntSet
-    return rv;
+    return true;
 }
 
-//---------------------------------------------------------------------------
-
 istream& operator>>(istream& stream, IntSet& intSet)
 {
-    //keep inserting into int set as long as the stream contains input
-    int x = 0;
-    do
+    //one sentry for the whole read: it flushes a tied output stream (so
+    //prompts appear) and skips the leading whitespace
+    istream::sentry ready(stream);
+    if (!ready)
+    {
+        return stream;
+    }
+
+    //keep inserting into int set until -1 is read
+    streambuf* buffer = stream.rdbuf();
+    const int end = char_traits<char>::eof();
+    char chunk[TEXT_BUFFER];
+    while (true)
     {
-        stream >> x;
-        if (x != -1)
+        //parse whatever the stream already has buffered in one block. The
+        //block is still in the stream's buffer, so characters past the -1
+        //(or past a bad token) can be put back for the next read.
+        streamsize buffered = buffer->in_avail();
+        if (buffered > 0)
         {
-            intSet.insert(x);
+            int n = (int)buffer->sgetn(chunk,
+                min(buffered, (streamsize)TEXT_BUFFER));
+            int pos = 0;
+            bool crossesEnd = false;
+            while (true)
+            {
+                while (pos < n && isBlank(chunk[pos]))
+                {
+                    pos++;
+                }
+                if (pos == n)
+                {
+                    break;
+                }
+
+                //a token running to the end of the block may continue past
+                //it: return it and read it one character at a time below
+                int start = pos;
+                if (chunk[pos] == '-' || chunk[pos] == '+')
+                {
+                    pos++;
+                }
+                while (pos < n && isDigit(chunk[pos]))
+                {
+                    pos++;
+                }
+                if (pos == n)
+                {
+                    if (!putBack(buffer, chunk + start, n - start))
+                    {
+                        stream.setstate(ios::badbit);
+                        return stream;
+                    }
+                    crossesEnd = true;
+                    break;
+                }
+
+                int x = 0;
+                if (!parseInt(chunk + start, chunk + pos, x))
+                {
+                    if (!putBack(buffer, chunk + start, n - start))
+                    {
+                        stream.setstate(ios::badbit);
+                    }
+                    stream.setstate(ios::failbit);
+                    return stream;
+                }
+                if (x == -1)
+                {
+                    if (!putBack(buffer, chunk + pos, n - pos))
+                    {
+                        stream.setstate(ios::badbit);
+                    }
+                    return stream;
+                }
+                intSet.insert(x);
+            }
+
+            //whole block used: parse the next one
+            if (!crossesEnd)
+            {
+                continue;
+            }
         }
-    } 
-    while (x != -1);
 
-    return stream;
+        //nothing buffered (or a token crosses the end of the block): read
+        //one token a character at a time, letting the stream refill
+        int c = buffer->sgetc();
+        while (c != end && isBlank((char)c))
+        {
+            c = buffer->snextc();
+        }
+
+        char token[16];
+        int length = 0;
+        if (c == '-' || c == '+')
+        {
+            token[length++] = (char)c;
+            c = buffer->snextc();
+        }
+        while (c != end && isDigit((char)c) && length < (int)sizeof(token))
+        {
+            token[length++] = (char)c;
+            c = buffer->snextc();
+        }
+
+        //anything but a whole int (or the end of input) ends the read
+        int x = 0;
+        if (!parseInt(token, token + length, x))
+        {
+            stream.setstate(c == end ? ios::failbit | ios::eofbit
+                : ios::failbit);
+            return stream;
+        }
+        if (x == -1)
+        {
+            if (c == end)
+            {
+                stream.setstate(ios::eofbit);
+            }
+            return stream;
+        }
+        intSet.insert(x);
+    }
 }
 
 //---------------------------------------------------------------------------
 
 ostream& operator<<(ostream& stream, const IntSet& intSet)
 {
+    //non-decimal or padded output, or a locale that may group digits,
+    //keeps going through the stream's own formatting, one value at a time
+    if ((stream.flags() & (ios::basefield | ios::showpos)) != ios::dec ||
+        stream.width() != 0 || stream.getloc() != locale::classic())
+    {
+        stream << "{";
+        for (IntSet::Iterator it = intSet.begin(); it != intSet.end(); ++it)
+        {
+            stream << " " << *it;
+        }
+        stream << "}" << "\n";
+        return stream;
+    }
+
     //opening curly bracket
-    int size = intSet.getSize();
-    stream << "{";
+    char buffer[TEXT_BUFFER];
+    int used = 0;
+    buffer[used++] = '{';
 
-    //space followed by each element of the set
-    for (int i = 0; i < size; i++)
-    {   
-        //only true indexes will be added to stream
-        if (intSet[i])
+    //space followed by each element of the set, formatted with to_chars;
+    //the buffer is written out whenever it might not fit another value
+    for (IntSet::Iterator it = intSet.begin(); it != intSet.end(); ++it)
+    {
+        if (used > TEXT_BUFFER - 16)
         {
-            stream << " " << i;
+            stream.write(buffer, used);
+            used = 0;
         }
+        buffer[used++] = ' ';
+        used = (int)(to_chars(buffer + used, buffer + TEXT_BUFFER, *it).ptr -
+            buffer);
     }
 
     //closing curly bracket
-    stream << "}" << "\n";
+    buffer[used++] = '}';
+    buffer[used++] = '\n';
+    stream.write(buffer, used);
 
     return stream;
 }
@@ -12,37 +12,88 @@
 // -- inputs are only integers
 // -- int set is dynamically allocated
 // -- in <<, integers are preceded by a space and followed by a comma
-// -- in >>, integers are expected (but gives output for chars as well)
+// -- in >>, integers are expected; anything else (or the end of input)
+//    before the closing -1 stops the read and sets failbit
+// -- << and >> format and parse through a local buffer with to_chars and
+//    from_chars instead of one formatted stream call per value (<< falls
+//    back to the stream's formatting for non-decimal or padded output, or
+//    for a locale other than the classic one)
 // -- user can input a maximum of 5 integers for instantiating the int set
 // -- using -1 at the end closes an input stream and instantiates the intset
-// -- size is the number of elements in the int set array
+// -- size is the number of possible values (0 to size - 1) in the int set;
+//    since size is an int, the largest value a set can hold is INT_MAX - 1
+// -- membership is packed into 64-bit words, one bit per possible value
+// -- capacity (allocated words) is kept separately from size and grows
+//    geometrically, so inserting ascending values costs amortized O(1)
+// -- sets of up to 256 possible values keep their words inside the object
+//    (INLINE_WORDS), so creating, copying and destroying them never touches
+//    the heap
+// -- larger sets keep their words on the heap with a reference count:
+//    copying a set shares its words in O(1), and the words are copied only
+//    when one of the sharing sets is first changed (copy-on-write)
+// -- sparse mode: a set whose words would be mostly empty (more than 1024
+//    words, fewer members than words) keeps its members in a SparseIntSet
+//    instead, in 65536-value chunks that are each a sorted array, a bitmap
+//    or a run list, so memory tracks the members rather than the largest
+//    value. A set switches when growing would allocate such words, and
+//    switches back to words once it has 4 members per word. Every
+//    operation works in either mode; operators with a sparse operand work
+//    chunk by chunk. Sparse chunks are copied, not shared, and reserve()
+//    and shrinkToFit() do nothing in sparse mode.
+// -- the number of members is maintained, so count() and isEmpty() are O(1)
+// -- hash() is cached until the set changes and only mixes in the words
+//    that hold members (so both modes hash alike); == rejects sets whose
+//    sizes, counts or cached hashes differ before comparing any words.
+//    The cache is published with atomics, so const calls (hash(), ==,
+//    copying) may run on one set from several threads at once; changing
+//    a set still needs exclusive access
+// -- rank() and select() use a directory of cumulative counts, one entry
+//    per 512 values, built on first use and dropped whenever the set
+//    changes; like the hash, it is published atomically, so rank() and
+//    select() may also run on one set from several threads at once
+// -- begin()/end() iterate over the members in ascending order
+// -- +, * and - return expression nodes (IntSetExpr) instead of IntSets;
+//    assigning an expression to an IntSet evaluates it in a single pass,
+//    word by word, with no intermediate sets (a plain A + B, A * B or A - B
+//    uses the SIMD kernels). Expressions refer to their IntSet operands, so
+//    they should be assigned (or printed) in the statement that builds them.
+// -- +, *, -, the compound operators, == and containsSet() split sets of
+//    more than 2^18 words (16M values) across the hardware threads, so the
+//    program must be linked with the platform's thread library (-pthread)
+// -- saveSnapshot() writes a binary snapshot: a 64-byte versioned header
+//    followed by the raw words. mapSnapshot() maps such a file into memory
+//    and uses the words in place (no copy, no parsing). A mapped set is a
+//    read-only view: the first change to it copies the words into its own
+//    buffer and releases the mapping.
 //---------------------------------------------------------------------------
 #ifndef INTSET_H
 #define INTSET_H
 
 #include <iostream>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <utility>
+#include <climits>
+#include <iterator>
+#include <type_traits>
+#include <functional>
+#include <vector>
+#include "bitops.h"
+#include "sparseintset.h"
 using namespace std;
 
+template <class Op, class L, class R> class IntSetExpr;
+
 class IntSet
 { 
-    // operator +
-    // Overloaded adding operator. Returns the union of two IntSets.
-    // Preconditions: the IntSets' array pointers must not be null or dangling
-    // Postconditions: the IntSet parameters remain unchanged
-    friend IntSet operator + (const IntSet&, const IntSet&);  
-
-    // operator *
-    // Overloaded multiply operator. Returns the intersection of two IntSets.
-    // Preconditions: the IntSets' array pointers must not be null or dangling
-    // Postconditions: the IntSet parameters remain unchanged
-    friend IntSet operator * (const IntSet&, const IntSet&);    
-
-    // operator -
-    // Overloaded minus operator. Returns elements in first and not in second
-    // Preconditions: the IntSets' array pointers must not be null or dangling
-    // Postconditions: the IntSet parameters remain unchanged
-    friend IntSet operator - (const IntSet&, const IntSet&);
+    // IntSetExpr
+    // expression nodes read the words of the IntSets they refer to
+    template <class Op, class L, class R> friend class IntSetExpr;
+
+    // ConcurrentIntSet
+    // toIntSet() sizes the IntSet it builds once and copies whole words in
+    friend class ConcurrentIntSet;
 
     // operator >>
     // Overloaded input operator for IntSet. Inputs values into the int set.
@@ -64,11 +115,35 @@ public:
     IntSet(int = -1, int = -1, int = -1, int = -1, int = -1);
 
     // Copy constructor
-    // Deep copy of the IntSet object
+    // Copy of the IntSet object (sharing its heap words until either changes)
     // Preconditions: IntSet object must be declared elsewhere in advance.
     // Postconditions: IntSet argument remains unchanged
     IntSet(const IntSet&);
 
+    // Constructor from a set expression
+    // Evaluates an expression such as (A * B) + D in a single pass
+    // Preconditions: the IntSets in the expression must still exist
+    // Postconditions: the IntSet holds the value of the expression
+    template <class Op, class L, class R>
+    IntSet(const IntSetExpr<Op, L, R>&);
+
+    // Constructor from an iterator range
+    // Inserts every value in [first, last), e.g. from a vector or an array.
+    // Forward iterators are read twice: once to size the words from the
+    // largest value, once to set the bits, so unsorted input allocates once.
+    // (Only iterators to integers match, so IntSet(a, b) is unaffected.)
+    // Preconditions: the values must be below INT_MAX
+    // Postconditions: negative values are ignored
+    template <class InputIt, class = typename enable_if<is_integral<
+        typename iterator_traits<InputIt>::value_type>::value>::type>
+    IntSet(InputIt, InputIt);
+
+    // Move constructor
+    // Takes over the words of a temporary IntSet without copying them
+    // Preconditions: none
+    // Postconditions: IntSet argument is left as an empty set of size 0
+    IntSet(IntSet&&) noexcept;
+
     // Destructor
     // Preconditions: IntSet exists on the heap
     // Postconditions: Ints are cleared, size is set to 0
@@ -76,29 +151,60 @@ public:
 
     // operator =
     // Overloaded assignment operator
-    // Assigns one IntSet to another by doing a deep copy
+    // Assigns one IntSet to another; heap words are shared until either
+    // set changes, small and mapped sets are copied
     // Preconditions: IntSet exists on the heap
     // Postconditions: "this" obtains the values of the IntSet parameter
     IntSet& operator = (const IntSet&);
 
+    // operator = (move)
+    // Overloaded move assignment operator
+    // Releases this IntSet's words and takes over those of the argument
+    // Preconditions: none
+    // Postconditions: IntSet argument is left as an empty set of size 0
+    IntSet& operator = (IntSet&&) noexcept;
+
+    // operator = (expression)
+    // Evaluates the expression straight into this IntSet's words (reusing
+    // them when they are large enough), in a single pass. The expression may
+    // refer to this IntSet, as in D = (A * B) + D.
+    // Preconditions: the IntSets in the expression must still exist
+    // Postconditions: "this" holds the value of the expression
+    template <class Op, class L, class R>
+    IntSet& operator = (const IntSetExpr<Op, L, R>&);
+
     // operator +=
     // modifies current object to be the union of itself and the other
+    // (in place: only reallocates when the other set holds larger values)
     // Preconditions: both IntSets do not have null array pointers
     // Postconditions: "this" IntSet becomes the union set of the two
     IntSet& operator += (const IntSet&);
 
     // operator *=
     // modifies current object to be the intersection of itself and the other
+    // (in place: never allocates)
     // Preconditions: both IntSets do not have null array pointers
     // Postconditions: "this" IntSet becomes the intersection set of the two
     IntSet& operator *= (const IntSet&);
 
     // operator -=
     // modifies current object to be the difference of itself and the other
+    // (in place: never allocates)
     // Preconditions: both IntSets do not have null array pointers
     // Postconditions: "this" IntSet becomes the difference set of the two
     IntSet& operator -= (const IntSet&);
 
+    // operator +=, *=, -= (expression)
+    // Same as above, fused with the evaluation of the expression
+    // Preconditions: the IntSets in the expression must still exist
+    // Postconditions: "this" IntSet holds the result
+    template <class Op, class L, class R>
+    IntSet& operator += (const IntSetExpr<Op, L, R>&);
+    template <class Op, class L, class R>
+    IntSet& operator *= (const IntSetExpr<Op, L, R>&);
+    template <class Op, class L, class R>
+    IntSet& operator -= (const IntSetExpr<Op, L, R>&);
+
     // operator ==
     // Checks whether two IntSets are equal
     // Preconditions: both IntSets do not have null array pointers
@@ -111,6 +217,13 @@ public:
     // Postconditions: both IntSets remain unchanged
     bool operator != (const IntSet&) const;
 
+    // hash()
+    // Returns a hash of the members (equal sets give equal hashes), cached
+    // until the set changes; std::hash<IntSet> calls it
+    // Preconditions: none
+    // Postconditions: may cache the hash; the set is unchanged
+    size_t hash() const;
+
     // insert()
     // inserts the supplied integer into the set
     // Preconditions: IntSet arraySet must not be null
@@ -123,8 +236,17 @@ public:
     // Postconditions: int value is removed from the IntSet
     bool remove(int);
 
+    // insertRange(), removeRange()
+    // insert or remove every value from lo to hi - 1, a word at a time
+    // Preconditions: none
+    // Postconditions: insertRange returns false (set unchanged) if lo is
+    //                 negative or hi < lo; removeRange ignores values
+    //                 outside the set and returns true if any were removed
+    bool insertRange(int, int);
+    bool removeRange(int, int);
+
     // isEmpty()
-    // checks whether the current IntSet is empty
+    // checks whether the current IntSet holds no values
     // Preconditions: IntSet must be initialized before usage
     // Postconditions: does not modify IntSet
     bool isEmpty() const;
@@ -141,6 +263,33 @@ public:
     // Postconditions: both IntSets remain unchanged
     bool containsSet(const IntSet&) const;
 
+    // intersectionCount(), unionCount(), differenceCount()
+    // Return the number of values in this * other, this + other and
+    // this - other, counted directly from both sets' words
+    // Preconditions: none
+    // Postconditions: both IntSets remain unchanged; no set is built
+    int intersectionCount(const IntSet&) const;
+    int unionCount(const IntSet&) const;
+    int differenceCount(const IntSet&) const;
+
+    // jaccard()
+    // Returns the Jaccard similarity |this * other| / |this + other|
+    // Preconditions: none
+    // Postconditions: returns 1.0 when both sets are empty; both IntSets
+    //                 remain unchanged
+    double jaccard(const IntSet&) const;
+
+    // unionAll(), intersectAll()
+    // Return the union or intersection of count sets, built in one sweep:
+    // the result is sized once and every block of words is combined across
+    // all the sets before moving on. The intersection of a block stops as
+    // soon as it becomes empty, and the whole intersection stops at once if
+    // one of the sets is empty.
+    // Preconditions: sets must point to count valid IntSet pointers
+    // Postconditions: the sets remain unchanged; no sets give an empty set
+    static IntSet unionAll(const IntSet* const*, int);
+    static IntSet intersectAll(const IntSet* const*, int);
+
     // operator []
     // Retrieves an array element by using the IntSet interface
     // Preconditions: element is within bounds of the array set
@@ -148,14 +297,311 @@ public:
     bool operator [] (int) const;
 
     // getSize()
-    // Returns the size of the int set array
+    // Returns the number of possible values the int set can currently hold
     // Preconditions: none
     // Postconditions: does not modify any data members
     int getSize() const;
 
+    // count()
+    // Returns the number of values in the set
+    // Preconditions: none
+    // Postconditions: does not modify any data members
+    int count() const;
+
+    // rank()
+    // Returns the number of values in the set that are smaller than x
+    // Preconditions: none
+    // Postconditions: may build the rank directory; set is unchanged
+    int rank(int) const;
+
+    // select()
+    // Returns the k-th smallest value in the set (k = 0 is the smallest)
+    // Preconditions: none
+    // Postconditions: returns -1 if k is not below count(); may build the
+    //                 rank directory; set is unchanged
+    int select(int) const;
+
+    // UnionOp, IntersectionOp, DifferenceOp
+    // Describe how +, * and - combine one word of each operand, the size of
+    // the result, and (fill) how to write the result of two plain IntSets
+    // with the word kernels. fill returns the number of bits it set.
+    // combine applies the compound operator, for operands in sparse mode.
+    struct UnionOp
+    {
+        static uint64_t apply(uint64_t a, uint64_t b) { return a | b; }
+        static int size(int a, int b) { return (a > b) ? a : b; }
+        static int fill(uint64_t*, const IntSet&, const IntSet&);
+        static void combine(IntSet& a, const IntSet& b) { a += b; }
+    };
+
+    struct IntersectionOp
+    {
+        static uint64_t apply(uint64_t a, uint64_t b) { return a & b; }
+        static int size(int a, int b) { return (a < b) ? a : b; }
+        static int fill(uint64_t*, const IntSet&, const IntSet&);
+        static void combine(IntSet& a, const IntSet& b) { a *= b; }
+    };
+
+    struct DifferenceOp
+    {
+        static uint64_t apply(uint64_t a, uint64_t b) { return a & ~b; }
+        static int size(int a, int) { return a; }
+        static int fill(uint64_t*, const IntSet&, const IntSet&);
+        static void combine(IntSet& a, const IntSet& b) { a -= b; }
+    };
+
+    // Iterator
+    // Forward iterator over the values of the set in ascending order. Each
+    // step jumps straight to the next set bit, skipping empty words (in
+    // sparse mode, the chunks supply the next word holding members).
+    // The iterator is invalidated by any change to the set.
+    class Iterator
+    {
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const int* pointer;
+        typedef int reference;
+
+        Iterator();                             //end iterator
+        Iterator(const uint64_t*, int);         //first value of the words
+        Iterator(const SparseIntSet*);          //first value of the chunks
+        int operator * () const;                //current value
+        Iterator& operator ++ ();               //move to the next value
+        Iterator operator ++ (int);
+        bool operator == (const Iterator&) const;
+        bool operator != (const Iterator&) const;
+
+    private:
+        const uint64_t* words;                  //words being iterated
+        int wordCount;                          //number of words
+        int wordIndex;                          //index of current word
+        uint64_t remaining;                     //unvisited bits of the word
+        const SparseIntSet* sparse;             //chunks, in sparse mode
+
+        // skipEmptyWords()
+        // moves forward until a word with unvisited bits is found
+        void skipEmptyWords();
+    };
+
+    // begin(), end()
+    // Return iterators to the smallest value and past the largest value
+    // Preconditions: none
+    // Postconditions: does not modify any data members
+    Iterator begin() const;
+    Iterator end() const;
+
+    // reserve()
+    // Makes room for values up to the given maximum without reallocating
+    // (does nothing in sparse mode)
+    // Preconditions: none (negative values are ignored)
+    // Postconditions: set contents and size are unchanged
+    void reserve(int);
+
+    // shrinkToFit()
+    // Releases the spare words that are not needed by the current size
+    // (does nothing in sparse mode)
+    // Preconditions: none
+    // Postconditions: set contents and size are unchanged
+    void shrinkToFit();
+
+    // getCapacity()
+    // Returns the number of values the set can hold before reallocating
+    // (its size in sparse mode)
+    // Preconditions: none
+    // Postconditions: does not modify any data members
+    int getCapacity() const;
+
+    // saveSnapshot()
+    // Writes the set to the given file in the binary snapshot format
+    // Preconditions: none
+    // Postconditions: returns false if the file could not be written
+    bool saveSnapshot(const char*) const;
+
+    // mapSnapshot()
+    // Replaces the set with a read-only view of a snapshot file
+    // Preconditions: the file must not change while it is mapped
+    // Postconditions: returns false, leaving the set unchanged, if the file
+    //                 cannot be mapped or is not a valid snapshot
+    bool mapSnapshot(const char*);
+
+    // isMapped()
+    // Checks whether the set is still a view of a mapped snapshot file
+    // Preconditions: none
+    // Postconditions: does not modify any data members
+    bool isMapped() const;
+
+    // isSparse()
+    // Checks whether the set is in sparse mode (members kept in chunks)
+    // Preconditions: none
+    // Postconditions: does not modify any data members
+    bool isSparse() const;
+
 private:
-    bool* arraySet;                         //pointer to access the array set
-    int size;                               //size of the array set
+    static const int WORD_BITS = 64;        //number of values held per word
+    static const int INLINE_WORDS = 4;      //words held inside the object
+    static const int SWEEP_WORDS = 512;     //words combined per k-way step
+    static const int MAX_VALUE = INT_MAX - 1;//largest value (size fits int)
+    static const int SPARSE_MIN_WORDS = 1024;//sets this small stay in words
+    static const int DENSE_MEMBERS_PER_WORD = 4;//members/word ending sparse
+
+    uint64_t* arraySet;                     //pointer to the packed words
+    int size;                               //number of possible values
+    int capacity;                           //number of allocated words
+    int population;                         //number of values in the set
+    uint64_t inlineWords[INLINE_WORDS];     //words of small sets
+    void* mapping;                          //mapped snapshot, or null
+    size_t mappingBytes;                    //length of the mapped snapshot
+    SparseIntSet* sparse;                   //chunks in sparse mode, or null
+
+    static const int RANK_BLOCK_WORDS = 8;  //words per rank directory entry
+
+    mutable atomic<int*> rankDirectory{nullptr};//members before each block
+    mutable atomic<size_t> hashValue{0};    //cached result of hash()
+    mutable atomic<bool> hashValid{false};  //hashValue matches the words
+
+    // allocate()
+    // Replaces the current words with an empty set of the given size
+    // Preconditions: the size must not be negative
+    // Postconditions: all values are removed, size is set to the argument
+    void allocate(int);
+
+    // grow()
+    // Extends the set so it can hold the given number of values
+    // Preconditions: the new size must be larger than the current size
+    // Postconditions: existing values are kept, size is set to the argument
+    void grow(int);
+
+    // extend()
+    // Extends the set to the given number of values, expecting it to hold
+    // about the given number of members: words that would be mostly empty
+    // switch it to sparse mode instead of growing, and a sparse set that
+    // would fill its words switches back to them
+    // Preconditions: the new size must be larger than the current size
+    // Postconditions: existing values are kept, size is set to the argument
+    void extend(int, int);
+
+    // prefersSparse(), prefersWords()
+    // Check whether a set of the given number of words and members should
+    // switch to sparse mode, or back to words (the gap between the two
+    // keeps a set from switching back and forth)
+    static bool prefersSparse(int, int);
+    static bool prefersWords(int, int);
+
+    // makeSparse(), makeDense()
+    // Move the members from the words into chunks, or back
+    // Preconditions: the set must be in the other mode
+    // Postconditions: contents, size and population are unchanged
+    void makeSparse();
+    void makeDense();
+
+    // settle()
+    // Switches a sparse set back to words if it prefers them
+    // Preconditions: population must be up to date
+    // Postconditions: contents are unchanged
+    void settle();
+
+    // dropSparse()
+    // Discards the chunks of a set in sparse mode
+    // Preconditions: none
+    // Postconditions: the set is an empty set of size 0 on its inline words
+    void dropSparse();
+
+    // combineChunks()
+    // Applies a compound SparseIntSet operator to this set's chunks and the
+    // other set's members, then sets the size of the result
+    // Preconditions: this set must be in sparse mode
+    // Postconditions: population is updated; the set may go back to words
+    void combineChunks(const IntSet&,
+        SparseIntSet& (SparseIntSet::*)(const SparseIntSet&), int);
+
+    // wordAt(), nextWord()
+    // Return word i of the members in either mode (0 past the last word),
+    // and find the first word at or after i holding members: its index
+    // (or -1 if there is none) is returned and its bits stored
+    // Preconditions: the index must not be negative
+    // Postconditions: does not modify any data members
+    uint64_t wordAt(int) const;
+    int nextWord(int, uint64_t&) const;
+
+    // reallocate()
+    // Moves the words into a new buffer holding the given number of words
+    // Preconditions: the word count must cover the current size
+    // Postconditions: existing values are kept, capacity is the argument
+    void reallocate(int);
+
+    // releaseWords()
+    // Frees the words, or unmaps them if they belong to a mapped snapshot
+    // Preconditions: none
+    // Postconditions: the set is back on its inline words, whose contents
+    //                 are left for the caller to set; size and population
+    //                 are unchanged
+    void releaseWords();
+
+    // useInlineWords()
+    // Points the set at its inline words and clears them
+    // Preconditions: any heap words must already have been released
+    // Postconditions: capacity is INLINE_WORDS
+    void useInlineWords();
+
+    // takeWords()
+    // Takes over the words of the source set (copying inline words)
+    // Preconditions: this set's own words must already have been released
+    // Postconditions: the source is an empty set on its inline words
+    void takeWords(IntSet&);
+
+    // makeWritable()
+    // Prepares the words for an in-place change: copies the words of a
+    // mapped snapshot, or words shared with other sets, into a buffer the
+    // set owns alone, and drops the rank directory and the cached hash
+    // Preconditions: none
+    // Postconditions: the set is not mapped; contents are unchanged
+    void makeWritable();
+
+    // newWordBuffer(), freeWordBuffer(), shareWords()
+    // Allocate heap words (with a reference count of 1), drop one reference
+    // (freeing the words with the last one), or add one reference
+    static uint64_t* newWordBuffer(int);
+    static void freeWordBuffer(uint64_t*);
+    static void shareWords(uint64_t*);
+
+    // isSharable(), isShared()
+    // Check whether the words are on the heap (and so can be shared), and
+    // whether another set currently shares them
+    bool isSharable() const;
+    bool isShared() const;
+
+    // copyHash()
+    // Takes over the source's cached hash, if it has one
+    // Preconditions: the sets have the same words
+    // Postconditions: hashValid is set only if the source's hash was valid
+    void copyHash(const IntSet&);
+
+    // buildRankDirectory()
+    // Returns the members before each block of RANK_BLOCK_WORDS words,
+    // counting them first if the set changed since the last call
+    // Preconditions: none
+    // Postconditions: the directory stays valid until the set changes
+    const int* buildRankDirectory() const;
+
+    // dropRankDirectory()
+    // Frees the rank directory, which no longer matches the words
+    // Preconditions: no other thread may be using the set
+    // Postconditions: the next rank() or select() rebuilds it
+    void dropRankDirectory();
+
+    // wordsFor()
+    // Returns the number of words needed to hold the given number of values
+    // Preconditions: the number of values must not be negative
+    // Postconditions: none
+    static int wordsFor(int);
+
+    // wordCount()
+    // Returns the number of words currently allocated for the array set
+    // Preconditions: none
+    // Postconditions: does not modify any data members
+    int wordCount() const;
 
     // copy()
     // Copies all elements from the source IntSet to the dest IntSet
@@ -163,10 +609,558 @@ private:
     // Postconditions: dest IntSet contains source IntSet elements
     IntSet& copy(const IntSet&, IntSet*);
 
+    // word()
+    // Returns the given word of the set, or 0 past the last word
+    // Preconditions: the set must not be in sparse mode
+    uint64_t word(int) const;
+
+    // evaluate()
+    // Writes the value of an expression into this IntSet's words
+    // Preconditions: the IntSets in the expression must still exist
+    // Postconditions: size, population and words hold the result
+    template <class Op, class L, class R>
+    void evaluate(const IntSetExpr<Op, L, R>&);
+
+    // fillFrom()
+    // Inserts the values of an iterator range into a new, empty IntSet
+    // Preconditions: the set must be empty
+    // Postconditions: the set holds the non-negative values of the range
+    template <class InputIt>
+    void fillFrom(InputIt, InputIt, input_iterator_tag);
+    template <class ForwardIt>
+    void fillFrom(ForwardIt, ForwardIt, forward_iterator_tag);
+
+    // rangeMask()
+    // Returns the bits of the given word that hold values from lo to hi - 1
+    // Preconditions: the word must overlap the range
+    // Postconditions: none
+    static uint64_t rangeMask(int, int, int);
+
     // isWithinRange()
     // Checks whether the provided integer is within range
     // Preconditions: IntSet array must not be null
     // Postconditions: returns true if the variable is within range
     bool isWithinRange(int) const;
 };
+
+//---------------------------------------------------------------------------
+// IntSetExpr
+// An unevaluated +, * or - of two operands, each an IntSet (held by
+// reference) or another IntSetExpr (held by value). word(i) combines word i
+// of both operands, so evaluating a whole expression is one pass over memory
+// and word i of the result only depends on word i of the operands.
+
+// IntSetOperand
+// true for the types +, * and - accept; Stored is how a node holds them
+template <class T> struct IntSetOperand
+{
+    static const bool value = false;
+};
+
+template <> struct IntSetOperand<IntSet>
+{
+    static const bool value = true;
+    typedef const IntSet& Stored;
+};
+
+template <class Op, class L, class R> struct IntSetOperand<IntSetExpr<Op, L, R> >
+{
+    static const bool value = true;
+    typedef IntSetExpr<Op, L, R> Stored;
+};
+
+// operandValue()
+// Returns an operand of an expression as an IntSet
+inline const IntSet& operandValue(const IntSet& set)
+{
+    return set;
+}
+
+template <class Op, class L, class R>
+IntSet operandValue(const IntSetExpr<Op, L, R>& expr)
+{
+    return expr.value();
+}
+
+template <class Op, class L, class R>
+class IntSetExpr
+{
+public:
+    IntSetExpr(const L& l, const R& r) : left(l), right(r) {}
+
+    // isSparse()
+    // true if any IntSet in the expression is in sparse mode
+    bool isSparse() const
+    {
+        return left.isSparse() || right.isSparse();
+    }
+
+    // value()
+    // Returns the result, applying one compound operator at a time (for
+    // sparse operands, which have no words to combine)
+    IntSet value() const
+    {
+        IntSet result(operandValue(left));
+        Op::combine(result, operandValue(right));
+        return result;
+    }
+
+    // getSize()
+    // Returns the size the result will have
+    int getSize() const
+    {
+        return Op::size(left.getSize(), right.getSize());
+    }
+
+    // word()
+    // Returns word i of the result
+    uint64_t word(int i) const
+    {
+        return Op::apply(left.word(i), right.word(i));
+    }
+
+    // fill()
+    // Writes the first n words of the result; returns the bits set
+    int fill(uint64_t* dest, int n) const
+    {
+        int count = 0;
+        for (int i = 0; i < n; i++)
+        {
+            dest[i] = word(i);
+            count += popcount64(dest[i]);
+        }
+        return count;
+    }
+
+private:
+    typename IntSetOperand<L>::Stored left;     //left operand
+    typename IntSetOperand<R>::Stored right;    //right operand
+};
+
+// IntSetExpr of two plain IntSets: fill with the SIMD kernels
+template <class Op>
+class IntSetExpr<Op, IntSet, IntSet>
+{
+public:
+    IntSetExpr(const IntSet& l, const IntSet& r) : left(l), right(r) {}
+
+    bool isSparse() const
+    {
+        return left.isSparse() || right.isSparse();
+    }
+
+    IntSet value() const
+    {
+        IntSet result(left);
+        Op::combine(result, right);
+        return result;
+    }
+
+    int getSize() const
+    {
+        return Op::size(left.getSize(), right.getSize());
+    }
+
+    uint64_t word(int i) const
+    {
+        return Op::apply(left.word(i), right.word(i));
+    }
+
+    int fill(uint64_t* dest, int) const
+    {
+        return Op::fill(dest, left, right);
+    }
+
+private:
+    const IntSet& left;                         //left operand
+    const IntSet& right;                        //right operand
+};
+
+//---------------------------------------------------------------------------
+// operator +
+// Overloaded adding operator. Returns the union of two IntSets/expressions.
+// Preconditions: the IntSets' array pointers must not be null or dangling
+// Postconditions: the operands remain unchanged
+template <class L, class R>
+typename enable_if<IntSetOperand<L>::value && IntSetOperand<R>::value,
+    IntSetExpr<IntSet::UnionOp, L, R> >::type
+operator + (const L& left, const R& right)
+{
+    return IntSetExpr<IntSet::UnionOp, L, R>(left, right);
+}
+
+// operator *
+// Overloaded multiply operator. Returns the intersection of two operands.
+// Preconditions: the IntSets' array pointers must not be null or dangling
+// Postconditions: the operands remain unchanged
+template <class L, class R>
+typename enable_if<IntSetOperand<L>::value && IntSetOperand<R>::value,
+    IntSetExpr<IntSet::IntersectionOp, L, R> >::type
+operator * (const L& left, const R& right)
+{
+    return IntSetExpr<IntSet::IntersectionOp, L, R>(left, right);
+}
+
+// operator -
+// Overloaded minus operator. Returns elements in first and not in second
+// Preconditions: the IntSets' array pointers must not be null or dangling
+// Postconditions: the operands remain unchanged
+template <class L, class R>
+typename enable_if<IntSetOperand<L>::value && IntSetOperand<R>::value,
+    IntSetExpr<IntSet::DifferenceOp, L, R> >::type
+operator - (const L& left, const R& right)
+{
+    return IntSetExpr<IntSet::DifferenceOp, L, R>(left, right);
+}
+
+//---------------------------------------------------------------------------
+// operator +, *, - (temporary operands)
+// Same results as above, but the words of a temporary IntSet operand are
+// reused: the expression is evaluated in place into the temporary, which is
+// then moved out.
+// Preconditions: the IntSets' array pointers must not be null or dangling
+// Postconditions: lvalue operands remain unchanged
+template <class R>
+typename enable_if<IntSetOperand<R>::value, IntSet>::type
+operator + (IntSet&& left, const R& right)
+{
+    left = IntSetExpr<IntSet::UnionOp, IntSet, R>(left, right);
+    return std::move(left);
+}
+
+template <class L>
+typename enable_if<IntSetOperand<L>::value, IntSet>::type
+operator + (const L& left, IntSet&& right)
+{
+    right = IntSetExpr<IntSet::UnionOp, L, IntSet>(left, right);
+    return std::move(right);
+}
+
+inline IntSet operator + (IntSet&& left, IntSet&& right)
+{
+    left = IntSetExpr<IntSet::UnionOp, IntSet, IntSet>(left, right);
+    return std::move(left);
+}
+
+template <class R>
+typename enable_if<IntSetOperand<R>::value, IntSet>::type
+operator * (IntSet&& left, const R& right)
+{
+    left = IntSetExpr<IntSet::IntersectionOp, IntSet, R>(left, right);
+    return std::move(left);
+}
+
+template <class L>
+typename enable_if<IntSetOperand<L>::value, IntSet>::type
+operator * (const L& left, IntSet&& right)
+{
+    right = IntSetExpr<IntSet::IntersectionOp, L, IntSet>(left, right);
+    return std::move(right);
+}
+
+inline IntSet operator * (IntSet&& left, IntSet&& right)
+{
+    left = IntSetExpr<IntSet::IntersectionOp, IntSet, IntSet>(left, right);
+    return std::move(left);
+}
+
+template <class R>
+typename enable_if<IntSetOperand<R>::value, IntSet>::type
+operator - (IntSet&& left, const R& right)
+{
+    left = IntSetExpr<IntSet::DifferenceOp, IntSet, R>(left, right);
+    return std::move(left);
+}
+
+template <class L>
+typename enable_if<IntSetOperand<L>::value, IntSet>::type
+operator - (const L& left, IntSet&& right)
+{
+    right = IntSetExpr<IntSet::DifferenceOp, L, IntSet>(left, right);
+    return std::move(right);
+}
+
+inline IntSet operator - (IntSet&& left, IntSet&& right)
+{
+    left = IntSetExpr<IntSet::DifferenceOp, IntSet, IntSet>(left, right);
+    return std::move(left);
+}
+
+//---------------------------------------------------------------------------
+// operator << (expression)
+// Evaluates the expression and outputs it like an IntSet
+// Preconditions: the IntSets in the expression must still exist
+// Postconditions: the operands remain unchanged
+template <class Op, class L, class R>
+ostream& operator << (ostream& stream, const IntSetExpr<Op, L, R>& expr)
+{
+    return stream << IntSet(expr);
+}
+
+// operator ==, != (expression on the left)
+// Evaluates the expression and compares it like an IntSet
+// Preconditions: the IntSets in the expressions must still exist
+// Postconditions: the operands remain unchanged
+template <class Op, class L, class R, class T>
+typename enable_if<IntSetOperand<T>::value, bool>::type
+operator == (const IntSetExpr<Op, L, R>& left, const T& right)
+{
+    const IntSet& rightSet = right;
+    return IntSet(left) == rightSet;
+}
+
+template <class Op, class L, class R, class T>
+typename enable_if<IntSetOperand<T>::value, bool>::type
+operator != (const IntSetExpr<Op, L, R>& left, const T& right)
+{
+    return !(left == right);
+}
+
+//---------------------------------------------------------------------------
+// IntSet expression members
+
+template <class Op, class L, class R>
+IntSet::IntSet(const IntSetExpr<Op, L, R>& expr)
+    : arraySet(inlineWords), size(0), capacity(INLINE_WORDS), population(0),
+      inlineWords(), mapping(nullptr), mappingBytes(0), sparse(nullptr)
+{
+    evaluate(expr);
+}
+
+template <class InputIt, class>
+IntSet::IntSet(InputIt first, InputIt last)
+    : arraySet(inlineWords), size(0), capacity(INLINE_WORDS), population(0),
+      inlineWords(), mapping(nullptr), mappingBytes(0), sparse(nullptr)
+{
+    fillFrom(first, last,
+        typename iterator_traits<InputIt>::iterator_category());
+}
+
+template <class InputIt>
+void IntSet::fillFrom(InputIt first, InputIt last, input_iterator_tag)
+{
+    //single pass: the words grow as larger values arrive
+    for (; first != last; ++first)
+    {
+        insert((int)*first);
+    }
+}
+
+template <class ForwardIt>
+void IntSet::fillFrom(ForwardIt first, ForwardIt last, forward_iterator_tag)
+{
+    //first pass: size the words once from the largest value
+    int maxValue = -1;
+    int members = 0;
+    for (ForwardIt it = first; it != last; ++it)
+    {
+        maxValue = std::max(maxValue, (int)*it);
+        members++;
+    }
+    int values = (maxValue < MAX_VALUE ? maxValue : MAX_VALUE) + 1;
+
+    //words that would be mostly empty: insert into chunks instead
+    if (prefersSparse(wordsFor(values), members))
+    {
+        makeSparse();
+        size = values;
+        for (ForwardIt it = first; it != last; ++it)
+        {
+            insert((int)*it);
+        }
+        return;
+    }
+    allocate(values);
+
+    //second pass: set the bits with no range checks or reallocation
+    for (ForwardIt it = first; it != last; ++it)
+    {
+        int x = (int)*it;
+        if (x >= 0 && x <= MAX_VALUE)
+        {
+            arraySet[x / WORD_BITS] |= uint64_t(1) << (x % WORD_BITS);
+        }
+    }
+
+    //count the members once, after duplicates have collapsed
+    for (int i = 0; i < wordCount(); i++)
+    {
+        population += popcount64(arraySet[i]);
+    }
+}
+
+template <class Op, class L, class R>
+IntSet& IntSet::operator=(const IntSetExpr<Op, L, R>& expr)
+{
+    evaluate(expr);
+    return *this;
+}
+
+template <class Op, class L, class R>
+IntSet& IntSet::operator+=(const IntSetExpr<Op, L, R>& expr)
+{
+    evaluate(IntSetExpr<UnionOp, IntSet, IntSetExpr<Op, L, R> >(*this, expr));
+    return *this;
+}
+
+template <class Op, class L, class R>
+IntSet& IntSet::operator*=(const IntSetExpr<Op, L, R>& expr)
+{
+    evaluate(IntSetExpr<IntersectionOp, IntSet, IntSetExpr<Op, L, R> >(*this,
+        expr));
+    return *this;
+}
+
+template <class Op, class L, class R>
+IntSet& IntSet::operator-=(const IntSetExpr<Op, L, R>& expr)
+{
+    evaluate(IntSetExpr<DifferenceOp, IntSet, IntSetExpr<Op, L, R> >(*this,
+        expr));
+    return *this;
+}
+
+template <class Op, class L, class R>
+void IntSet::evaluate(const IntSetExpr<Op, L, R>& expr)
+{
+    //an operand in sparse mode has no words to combine: apply the
+    //operators one at a time, chunk by chunk
+    if (expr.isSparse())
+    {
+        *this = expr.value();
+        return;
+    }
+
+    //this set is not an operand, so any chunks it has can go
+    dropSparse();
+    int newSize = expr.getSize();
+    int newWords = wordsFor(newSize);
+    dropRankDirectory();
+    hashValid.store(false, memory_order_relaxed);
+
+    //not enough room (or read-only or shared words): evaluate into a new
+    //buffer, since the expression may still be reading this set's words
+    if (newWords > capacity || mapping != nullptr || isShared())
+    {
+        uint64_t* newArraySet = newWordBuffer(newWords);
+        population = expr.fill(newArraySet, newWords);
+        releaseWords();
+        arraySet = newArraySet;
+        capacity = newWords;
+        size = newSize;
+        return;
+    }
+
+    //enough room: word i of the result only reads word i of each operand,
+    //so it can overwrite word i of this set even if this set is an operand
+    int oldWords = wordCount();
+    population = expr.fill(arraySet, newWords);
+
+    //clear the words past the new size so the spare capacity stays empty
+    for (int i = newWords; i < oldWords; i++)
+    {
+        arraySet[i] = 0;
+    }
+    size = newSize;
+}
+
+inline uint64_t IntSet::word(int i) const
+{
+    return (i < wordCount()) ? arraySet[i] : 0;
+}
+
+//---------------------------------------------------------------------------
+// IntSet::Iterator
+// Defined here so that iterating compiles down to a ctz and a mask per value.
+// An exhausted iterator is reset to the same state as end().
+
+inline IntSet::Iterator::Iterator()
+    : words(nullptr), wordCount(0), wordIndex(0), remaining(0),
+      sparse(nullptr)
+{
+}
+
+inline IntSet::Iterator::Iterator(const uint64_t* w, int n)
+    : words(w), wordCount(n), wordIndex(0), remaining(n > 0 ? w[0] : 0),
+      sparse(nullptr)
+{
+    skipEmptyWords();
+}
+
+inline IntSet::Iterator::Iterator(const SparseIntSet* s)
+    : words(nullptr), wordCount(0), wordIndex(-1), remaining(0), sparse(s)
+{
+    skipEmptyWords();
+}
+
+inline int IntSet::Iterator::operator*() const
+{
+    //value = word index * 64 + position of the lowest unvisited bit
+    return wordIndex * WORD_BITS + ctz64(remaining);
+}
+
+inline IntSet::Iterator& IntSet::Iterator::operator++()
+{
+    //clear the lowest unvisited bit, then find the next one
+    remaining &= remaining - 1;
+    skipEmptyWords();
+    return *this;
+}
+
+inline IntSet::Iterator IntSet::Iterator::operator++(int)
+{
+    Iterator old = *this;
+    ++(*this);
+    return old;
+}
+
+inline bool IntSet::Iterator::operator==(const Iterator& other) const
+{
+    return words == other.words && sparse == other.sparse &&
+        wordIndex == other.wordIndex && remaining == other.remaining;
+}
+
+inline bool IntSet::Iterator::operator!=(const Iterator& other) const
+{
+    return !(*this == other);
+}
+
+inline void IntSet::Iterator::skipEmptyWords()
+{
+    while (remaining == 0)
+    {
+        //sparse mode: the chunks find the next word holding members
+        if (sparse != nullptr)
+        {
+            wordIndex = sparse->nextWord(wordIndex + 1, remaining);
+            if (wordIndex == -1)
+            {
+                *this = Iterator();
+            }
+            return;
+        }
+
+        //no words left: become the end iterator
+        if (++wordIndex >= wordCount)
+        {
+            *this = Iterator();
+            return;
+        }
+        remaining = words[wordIndex];
+    }
+}
+//---------------------------------------------------------------------------
+// std::hash<IntSet>
+// lets IntSets be keys of unordered_map and unordered_set
+
+namespace std
+{
+    template <>
+    struct hash<IntSet>
+    {
+        size_t operator()(const IntSet& intSet) const
+        {
+            return intSet.hash();
+        }
+    };
+}
 #endif
@@ -0,0 +1,319 @@
+// intsetbench times IntSet (and SparseIntSet, for comparison) across
+// universe sizes and densities, and prints the results as JSON.
+//
+// Build:  g++ -std=c++17 -O2 -pthread intsetbench.cpp intset.cpp
+//             sparseintset.cpp -o intsetbench
+// Run:    ./intsetbench [maxSize [maxMembers]] > results.json
+//
+// -- sizes (number of possible values) run from 64 up to maxSize
+//    (default 10^9) and densities from 0.001% to 100%
+// -- a size/density pair is skipped when it would hold more than
+//    maxMembers values (default 10^8), to bound the memory and fill time
+// -- every operation is repeated until it has run for about 20 ms, and the
+//    mean time per operation is reported in nanoseconds
+// -- stream I/O is only timed for sets of at most 10^6 members
+// -- the output is one JSON object: the configuration, then one record per
+//    (implementation, size, density, operation)
+
+#include "intset.h"
+#include "sparseintset.h"
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Settings
+
+static const double DENSITIES[] = { 0.00001, 0.0001, 0.001, 0.01, 0.1, 0.5,
+    1.0 };
+static const long long SIZES[] = { 64, 1000, 10000, 100000, 1000000,
+    10000000, 100000000, 1000000000 };
+static const double MIN_SECONDS = 0.02;         //time spent per operation
+static const int MAX_REPEATS = 1000000;         //repeat cap per operation
+static const int POINT_OPS = 4096;              //values per insert batch
+static const int MAX_IO_MEMBERS = 1000000;      //largest set for stream I/O
+
+//---------------------------------------------------------------------------
+// Random values
+// xorshift64* is fast enough that generating a 10^9-value set is dominated
+// by the inserts, and gives the same sets on every run and platform.
+
+struct Random
+{
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1)
+    {
+    }
+
+    uint64_t next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    //returns a value from 0 to bound - 1
+    int below(long long bound)
+    {
+        return (int)(next() % (uint64_t)bound);
+    }
+};
+
+//---------------------------------------------------------------------------
+// Timing
+
+//timeOperation()
+//runs op until MIN_SECONDS have passed; returns the mean nanoseconds per
+//call divided by perCall (the number of set operations one call makes).
+//Calls run in doubling batches so the clock is read only a few times.
+template <class Op>
+static double timeOperation(Op op, int perCall = 1)
+{
+    typedef chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    long long calls = 0;
+    for (long long batch = 1; ; batch *= 2)
+    {
+        for (long long i = 0; i < batch; i++)
+        {
+            op();
+        }
+        calls += batch;
+        elapsed = chrono::duration<double>(Clock::now() - start).count();
+        if (elapsed >= MIN_SECONDS || calls >= MAX_REPEATS)
+        {
+            break;
+        }
+    }
+
+    return elapsed * 1e9 / ((double)calls * perCall);
+}
+
+//---------------------------------------------------------------------------
+// Results
+
+//Report
+//collects the JSON records and prints them with commas between them
+struct Report
+{
+    bool first = true;
+
+    void record(const char* impl, long long size, double density,
+        int members, const char* op, double ns)
+    {
+        cout << (first ? "\n" : ",\n");
+        first = false;
+        cout << "    { \"impl\": \"" << impl << "\", \"size\": " << size
+            << ", \"density\": " << density << ", \"members\": " << members
+            << ", \"op\": \"" << op << "\", \"ns\": " << ns << " }";
+    }
+};
+
+//---------------------------------------------------------------------------
+// Benchmarks
+
+//fill()
+//inserts about size * density random values below size
+template <class Set>
+static void fill(Set& set, long long size, double density, uint64_t seed)
+{
+    Random random(seed);
+    if (density >= 0.1)
+    {
+        //dense: keep each value with the given probability
+        uint64_t threshold = (uint64_t)(density * 18446744073709551615.0);
+        for (long long x = 0; x < size; x++)
+        {
+            if (density >= 1.0 || random.next() <= threshold)
+            {
+                set.insert((int)x);
+            }
+        }
+    }
+    else
+    {
+        //sparse: draw the values directly (repeats are rare)
+        long long members = max(1LL, (long long)(size * density));
+        for (long long i = 0; i < members; i++)
+        {
+            set.insert(random.below(size));
+        }
+    }
+}
+
+//detach()
+//changes a set and changes it back, so a copy that shares its storage
+//(copy-on-write) gets its own before anything is timed
+template <class Set>
+static void detach(Set& set)
+{
+    if (set.isInSet(0))
+    {
+        set.remove(0);
+        set.insert(0);
+    }
+    else
+    {
+        set.insert(0);
+        set.remove(0);
+    }
+}
+
+//benchmark()
+//times every operation on sets of one size and density
+template <class Set>
+static void benchmark(Report& report, const char* impl, long long size,
+    double density)
+{
+    Set a, b, same;
+    fill(a, size, density, 1);
+    fill(b, size, density, 2);
+    fill(same, size, density, 1);
+    int members = a.count();
+
+    //writes the record for one operation
+    auto run = [&](const char* op, double ns)
+    {
+        report.record(impl, size, density, members, op, ns);
+    };
+
+    //point operations on a private copy, one batch of random values
+    Set work;
+    work = a;
+    detach(work);
+    vector<int> values(POINT_OPS);
+    Random random(3);
+    for (int& value : values)
+    {
+        value = random.below(size);
+    }
+
+    //each round inserts the batch then removes it again, so after the first
+    //round every insert adds a value and every remove takes one away
+    typedef chrono::steady_clock Clock;
+    double insertSeconds = 0;
+    double removeSeconds = 0;
+    long long rounds = 0;
+    while (insertSeconds + removeSeconds < 2 * MIN_SECONDS)
+    {
+        Clock::time_point start = Clock::now();
+        for (int value : values)
+        {
+            work.insert(value);
+        }
+        Clock::time_point middle = Clock::now();
+        for (int value : values)
+        {
+            work.remove(value);
+        }
+        insertSeconds += chrono::duration<double>(middle - start).count();
+        removeSeconds += chrono::duration<double>(Clock::now() - middle)
+            .count();
+        rounds++;
+    }
+    run("insert", insertSeconds * 1e9 / ((double)rounds * POINT_OPS));
+    run("remove", removeSeconds * 1e9 / ((double)rounds * POINT_OPS));
+
+    volatile int found = 0;
+    run("isInSet", timeOperation([&]
+    {
+        int hits = 0;
+        for (int value : values)
+        {
+            hits += a.isInSet(value);
+        }
+        found = found + hits;
+    }, POINT_OPS));
+
+    //set operators building a new set
+    run("union", timeOperation([&] { Set result = a + b; }));
+    run("intersection", timeOperation([&] { Set result = a * b; }));
+    run("difference", timeOperation([&] { Set result = a - b; }));
+
+    //compound operators on a private copy (repeats are idempotent)
+    work = a;
+    detach(work);
+    run("unionAssign", timeOperation([&] { work += b; }));
+    work = a;
+    detach(work);
+    run("intersectionAssign", timeOperation([&] { work *= b; }));
+    work = a;
+    detach(work);
+    run("differenceAssign", timeOperation([&] { work -= b; }));
+
+    //comparisons that have to look at every word or chunk
+    Set common = a * b;
+    volatile bool answer = false;
+    run("containsSet", timeOperation([&] { answer = a.containsSet(common); }));
+    run("equal", timeOperation([&] { answer = (a == same); }));
+
+    //copies: a copy may share storage, so also time copying then changing
+    run("copy", timeOperation([&] { Set copy(a); }));
+    run("copyWrite", timeOperation([&]
+    {
+        Set copy(a);
+        detach(copy);
+    }));
+    run("assign", timeOperation([&] { work = a; }));
+
+    //text I/O
+    if (members <= MAX_IO_MEMBERS)
+    {
+        ostringstream out;
+        out << a;
+        string text = out.str();
+        string input = text.substr(1, text.size() - 3) + " -1";
+        run("streamOut", timeOperation([&]
+        {
+            ostringstream stream;
+            stream << a;
+        }));
+        run("streamIn", timeOperation([&]
+        {
+            istringstream stream(input);
+            Set read;
+            stream >> read;
+        }));
+    }
+}
+
+//---------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    long long maxSize = (argc > 1) ? atoll(argv[1]) : 1000000000LL;
+    long long maxMembers = (argc > 2) ? atoll(argv[2]) : 100000000LL;
+
+    cout << "{\n  \"benchmark\": \"intset\",\n  \"maxSize\": " << maxSize
+        << ",\n  \"maxMembers\": " << maxMembers
+        << ",\n  \"results\": [";
+
+    Report report;
+    for (long long size : SIZES)
+    {
+        if (size > maxSize)
+        {
+            continue;
+        }
+        for (double density : DENSITIES)
+        {
+            if (size * density > maxMembers)
+            {
+                continue;
+            }
+            benchmark<IntSet>(report, "IntSet", size, density);
+            benchmark<SparseIntSet>(report, "SparseIntSet", size, density);
+        }
+    }
+
+    cout << "\n  ]\n}\n";
+    return 0;
+}
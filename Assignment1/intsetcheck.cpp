@@ -0,0 +1,252 @@
+// intsetcheck runs boundary checks on IntSet (and ConcurrentIntSet) that
+// lab1.cpp does not cover, and prints one line per failed check.
+//
+// Build:  g++ -std=c++17 -O2 -pthread intsetcheck.cpp intset.cpp
+//             sparseintset.cpp concurrentintset.cpp -o intsetcheck
+// Run:    ./intsetcheck
+//
+// -- exits with 0 when every check passes, 1 otherwise
+// -- this file replaces the global operator new and delete to count heap
+//    allocations and bytes, so the compound operators can be checked for
+//    making none, and sparse sets for staying small
+// -- the checks near INT_MAX need sets of 2^31 possible values, about
+//    256 MB of words each; only one such set is alive at a time
+
+#include "intset.h"
+#include "concurrentintset.h"
+#include <iostream>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Allocation counting
+// Every new and new[] in the program comes through here (the array forms
+// call these by default).
+
+static atomic<long> allocations(0);     //heap allocations so far
+static atomic<long> allocatedBytes(0);  //bytes asked for so far
+
+void* operator new(size_t bytes)
+{
+    allocations++;
+    allocatedBytes += (long)bytes;
+    void* memory = malloc(bytes == 0 ? 1 : bytes);
+    if (memory == nullptr)
+    {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+//---------------------------------------------------------------------------
+// Reporting
+
+static int failures = 0;                //number of failed checks
+
+//check()
+//prints the description of a check that did not hold
+static void check(bool holds, const char* description)
+{
+    if (!holds)
+    {
+        cout << "FAILED: " << description << endl;
+        failures++;
+    }
+}
+
+//---------------------------------------------------------------------------
+// Checks
+
+//checkLargeValues()
+//values near INT_MAX: the largest one that fits is INT_MAX - 1, since the
+//set's size (largest value + 1) is an int
+static void checkLargeValues()
+{
+    {
+        IntSet set;
+        check(set.insert(INT_MAX - 10), "insert(INT_MAX - 10) succeeds");
+        check(set.isInSet(INT_MAX - 10), "INT_MAX - 10 is in the set");
+        check(set.count() == 1, "set near INT_MAX holds one value");
+        check(set.getSize() == INT_MAX - 9, "size is INT_MAX - 9");
+        check(set.insert(INT_MAX - 1), "insert(INT_MAX - 1) succeeds");
+        check(set.isInSet(INT_MAX - 1), "INT_MAX - 1 is in the set");
+        check(!set.insert(INT_MAX), "insert(INT_MAX) is rejected");
+        check(set.remove(INT_MAX - 10), "remove(INT_MAX - 10) succeeds");
+        check(set.count() == 1, "one value left near INT_MAX");
+    }
+    {
+        IntSet set;
+        set.reserve(INT_MAX - 1);
+        check(set.getCapacity() >= INT_MAX - 1,
+            "reserve(INT_MAX - 1) makes room for INT_MAX - 1");
+        check(set.getSize() == 0, "reserve does not change the size");
+    }
+    {
+        IntSet set(INT_MAX);
+        check(set.isEmpty(), "IntSet(INT_MAX) holds no value");
+        check(set.getSize() == INT_MAX, "IntSet(INT_MAX) has size INT_MAX");
+    }
+    {
+        //a concurrent set stops where IntSet does, so every value it
+        //accepts survives toIntSet()
+        ConcurrentIntSet set(INT_MAX);
+        check(set.getMaxValue() == INT_MAX - 1,
+            "ConcurrentIntSet(INT_MAX) holds values up to INT_MAX - 1");
+        check(!set.insert(INT_MAX), "ConcurrentIntSet insert(INT_MAX) is "
+            "rejected");
+        check(set.insert(INT_MAX - 1), "ConcurrentIntSet insert(INT_MAX - 1) "
+            "succeeds");
+        long before = allocatedBytes;
+        IntSet copy = set.toIntSet();
+        check(allocatedBytes - before < 1024 * 1024,
+            "toIntSet() does not allocate words for every value");
+        check(copy.isInSet(INT_MAX - 1) && copy.count() == 1 &&
+            copy.getSize() == INT_MAX, "toIntSet() keeps INT_MAX - 1");
+    }
+}
+
+//checkSparseValues()
+//a few large values put the set in sparse mode instead of allocating words
+//for every smaller value (20000000 values would take 2.5 MB of words)
+static void checkSparseValues()
+{
+    {
+        long before = allocatedBytes;
+        IntSet set;
+        set.insert(20000000);
+        set.insert(1000);
+        check(allocatedBytes - before < 64 * 1024,
+            "insert(20000000) does not allocate words for every value");
+        check(set.isSparse(), "a set with two large values is sparse");
+        check(set.getSize() == 20000001, "sparse set has size 20000001");
+        check(set.isInSet(20000000) && set.isInSet(1000) &&
+            set.count() == 2, "sparse set holds both values");
+    }
+    {
+        long before = allocatedBytes;
+        IntSet set(20000000, 7);
+        check(allocatedBytes - before < 64 * 1024,
+            "IntSet(20000000, 7) does not allocate words for every value");
+        IntSet other;
+        other.insert(7);
+        other += set;
+        check(other == set, "+= with a sparse set gives the same set");
+    }
+    {
+        //filling the range switches the set back to words
+        IntSet set;
+        set.insert(1000000);
+        for (int x = 0; x < 100000; x++)
+        {
+            set.insert(x);
+        }
+        check(!set.isSparse(), "a filled set goes back to words");
+        check(set.count() == 100001, "the filled set holds every value");
+    }
+    {
+        //an empty range changes nothing, in the chunks or through IntSet
+        SparseIntSet chunks(100, 70000);
+        SparseIntSet before = chunks;
+        check(chunks.insertRange(100, 100) && chunks == before,
+            "SparseIntSet insertRange(100, 100) leaves the set unchanged");
+        check(!chunks.removeRange(100, 100) && chunks == before,
+            "SparseIntSet removeRange(100, 100) leaves the set unchanged");
+        IntSet set(20000000, 100);
+        IntSet copy = set;
+        check(set.insertRange(100, 100) && set == copy &&
+            set.count() == 2, "insertRange(100, 100) on a sparse set "
+            "leaves it unchanged");
+    }
+}
+
+//checkCompoundAllocations()
+//+=, *= and -= reuse the left operand's words when it already has room for
+//the result, so they must not allocate. Both sets are built separately
+//(not copied) so they do not share words copy-on-write.
+static void checkCompoundAllocations()
+{
+    IntSet left;
+    IntSet right;
+    IntSet smaller;
+    for (int x = 0; x < 10000; x += 3)
+    {
+        left.insert(x);
+    }
+    for (int x = 0; x < 10000; x += 5)
+    {
+        right.insert(x);
+    }
+    for (int x = 0; x < 500; x += 7)
+    {
+        smaller.insert(x);
+    }
+    right.reserve(left.getCapacity() - 1);
+
+    long before = allocations;
+    left += right;
+    check(allocations == before,
+        "+= with the same capacity makes no allocation");
+
+    before = allocations;
+    left *= right;
+    check(allocations == before,
+        "*= with the same capacity makes no allocation");
+
+    before = allocations;
+    left -= right;
+    check(allocations == before,
+        "-= with the same capacity makes no allocation");
+
+    before = allocations;
+    left += smaller;
+    left *= smaller;
+    left -= smaller;
+    check(allocations == before,
+        "compound ops with a smaller set make no allocation");
+
+    //the results must still be right (== and containsSet also compare
+    //the sizes, so compare the counts and the members one way)
+    IntSet expected;
+    for (int x = 0; x < 500; x += 7)
+    {
+        if (x % 3 == 0 || x % 5 == 0)
+        {
+            expected.insert(x);
+        }
+    }
+    IntSet result;
+    for (int x = 0; x < 10000; x += 3)
+    {
+        result.insert(x);
+    }
+    result += right;
+    result *= smaller;
+    check(result.count() == expected.count() && result.containsSet(expected),
+        "+= then *= gives the expected members");
+}
+
+//---------------------------------------------------------------------------
+
+int main()
+{
+    checkLargeValues();
+    checkSparseValues();
+    checkCompoundAllocations();
+
+    cout << (failures == 0 ? "all checks passed" : "some checks failed")
+        << endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,1323 @@
+// a SparseIntSet object holds positive integer values including zero,
+// stored in 65536-value chunks that are each an array, bitmap or run list.
+
+#include "sparseintset.h"
+#include "bitops.h"
+#include <algorithm>
+
+//---------------------------------------------------------------------------
+
+SparseIntSet::SparseIntSet(int a, int b, int c, int d, int e)
+{
+    //attempt to insert each of the arguments (negatives are ignored)
+    insert(a);
+    insert(b);
+    insert(c);
+    insert(d);
+    insert(e);
+}
+
+//---------------------------------------------------------------------------
+
+SparseIntSet& SparseIntSet::operator+=(const SparseIntSet& other)
+{
+    *this = *this + other;
+    return *this;
+}
+
+//---------------------------------------------------------------------------
+
+SparseIntSet& SparseIntSet::operator*=(const SparseIntSet& other)
+{
+    *this = *this * other;
+    return *this;
+}
+
+//---------------------------------------------------------------------------
+
+SparseIntSet& SparseIntSet::operator-=(const SparseIntSet& other)
+{
+    *this = *this - other;
+    return *this;
+}
+
+//---------------------------------------------------------------------------
+
+bool SparseIntSet::operator==(const SparseIntSet& other) const
+{
+    //check whether the memory locations are equal
+    if (this == &other)
+    {
+        return true;
+    }
+
+    //equal sets have the same chunks with the same values
+    if (chunks.size() != other.chunks.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        if (!chunkEquals(chunks[i], other.chunks[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool SparseIntSet::operator!=(const SparseIntSet& other) const
+{
+    return !(*this == other);
+}
+
+//---------------------------------------------------------------------------
+
+bool SparseIntSet::insert(int x)
+{
+    //negative values cannot be held
+    if (x < 0)
+    {
+        return false;
+    }
+
+    //find the chunk for the value, creating an empty array chunk if needed
+    int key = x >> CHUNK_BITS;
+    int i = findChunk(key);
+    if (i == -1)
+    {
+        Chunk chunk;
+        chunk.key = key;
+        chunk.type = ARRAY_CHUNK;
+        chunk.cardinality = 0;
+
+        //keep the chunks sorted by key
+        i = 0;
+        while (i < (int)chunks.size() && chunks[i].key < key)
+        {
+            i++;
+        }
+        chunks.insert(chunks.begin() + i, chunk);
+    }
+
+    chunkInsert(chunks[i], x & (CHUNK_VALUES - 1));
+    return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool SparseIntSet::remove(int x)
+{
+    //negative values are never in the set
+    if (x < 0)
+    {
+        return false;
+    }
+
+    //the value must be in an existing chunk
+    int i = findChunk(x >> CHUNK_BITS);
+    if (i == -1 || !chunkRemove(chunks[i], x & (CHUNK_VALUES - 1)))
+    {
+        return false;
+    }
+
+    //drop chunks that became empty
+    if (chunks[i].cardinality == 0)
+    {
+        chunks.erase(chunks.begin() + i);
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool SparseIntSet::isEmpty() const
+{
+    return chunks.empty();
+}
+
+//---------------------------------------------------------------------------
+
+bool SparseIntSet::isInSet(int x) const
+{
+    //negative values are never in the set
+    if (x < 0)
+    {
+        return false;
+    }
+
+    int i = findChunk(x >> CHUNK_BITS);
+    return i != -1 && chunkContains(chunks[i], x & (CHUNK_VALUES - 1));
+}
+
+//---------------------------------------------------------------------------
+
+bool SparseIntSet::containsSet(const SparseIntSet& subset) const
+{
+    //every chunk of the subset must be covered by the matching chunk here
+    size_t i = 0;
+    for (size_t j = 0; j < subset.chunks.size(); j++)
+    {
+        //skip the chunks of this set that come before the subset chunk
+        while (i < chunks.size() && chunks[i].key < subset.chunks[j].key)
+        {
+            i++;
+        }
+
+        //no matching chunk, or the chunk is missing some of the values
+        if (i == chunks.size() || chunks[i].key != subset.chunks[j].key ||
+            !chunkSubset(subset.chunks[j], chunks[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool SparseIntSet::operator[](int x) const
+{
+    return isInSet(x);
+}
+
+//---------------------------------------------------------------------------
+
+int SparseIntSet::getSize() const
+{
+    //largest value lives in the last chunk
+    if (chunks.empty())
+    {
+        return 0;
+    }
+
+    const Chunk& last = chunks.back();
+    return (last.key << CHUNK_BITS) + chunkMax(last) + 1;
+}
+
+//---------------------------------------------------------------------------
+
+int SparseIntSet::count() const
+{
+    int total = 0;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        total += chunks[i].cardinality;
+    }
+    return total;
+}
+
+//---------------------------------------------------------------------------
+
+size_t SparseIntSet::memoryUsage() const
+{
+    size_t total = chunks.size() * sizeof(Chunk);
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        total += chunkBytes(chunks[i]);
+    }
+    return total;
+}
+
+//---------------------------------------------------------------------------
+
+bool SparseIntSet::insertRange(int lo, int hi)
+{
+    if (lo < 0 || hi < lo)
+    {
+        return false;
+    }
+    if (lo == hi)
+    {
+        return true;
+    }
+
+    changeRange(lo, hi, true);
+    return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool SparseIntSet::removeRange(int lo, int hi)
+{
+    //negative values are never in the set
+    lo = max(lo, 0);
+    if (lo >= hi)
+    {
+        return false;
+    }
+
+    return changeRange(lo, hi, false) > 0;
+}
+
+//---------------------------------------------------------------------------
+
+int SparseIntSet::rank(int x) const
+{
+    if (x <= 0)
+    {
+        return 0;
+    }
+
+    //whole chunks below x's chunk, then the values below x in its chunk
+    int key = x >> CHUNK_BITS;
+    int total = 0;
+    for (size_t i = 0; i < chunks.size() && chunks[i].key <= key; i++)
+    {
+        total += (chunks[i].key < key) ? chunks[i].cardinality
+            : chunkRank(chunks[i], x & (CHUNK_VALUES - 1));
+    }
+    return total;
+}
+
+//---------------------------------------------------------------------------
+
+int SparseIntSet::select(int k) const
+{
+    if (k < 0)
+    {
+        return -1;
+    }
+
+    //skip whole chunks until the one holding the k-th value
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        if (k < chunks[i].cardinality)
+        {
+            return (chunks[i].key << CHUNK_BITS) + chunkSelect(chunks[i], k);
+        }
+        k -= chunks[i].cardinality;
+    }
+    return -1;
+}
+
+//---------------------------------------------------------------------------
+
+void SparseIntSet::assignWords(const uint64_t* words, int count)
+{
+    chunks.clear();
+
+    //one chunk per block of CHUNK_WORDS words that holds any value
+    vector<uint64_t> bits(CHUNK_WORDS);
+    for (int start = 0; start < count; start += CHUNK_WORDS)
+    {
+        int length = (count - start < CHUNK_WORDS) ? count - start
+            : CHUNK_WORDS;
+        bool any = false;
+        for (int i = 0; i < length; i++)
+        {
+            bits[i] = words[start + i];
+            any = any || bits[i] != 0;
+        }
+        if (!any)
+        {
+            continue;
+        }
+        fill(bits.begin() + length, bits.end(), uint64_t(0));
+
+        Chunk chunk;
+        chunk.key = start / CHUNK_WORDS;
+        chunkFromBits(chunk, bits.data());
+        chunks.push_back(chunk);
+    }
+}
+
+//---------------------------------------------------------------------------
+
+uint64_t SparseIntSet::word(int i) const
+{
+    int k = findChunk(i / CHUNK_WORDS);
+    if (k == -1)
+    {
+        return 0;
+    }
+
+    //a bitmap holds the word as it is; otherwise look for values in it
+    const Chunk& chunk = chunks[k];
+    int local = i % CHUNK_WORDS;
+    if (chunk.type == BITMAP_CHUNK)
+    {
+        return chunk.bits[local];
+    }
+    uint64_t bits = 0;
+    return (chunkNextWord(chunk, local, bits) == local) ? bits : 0;
+}
+
+//---------------------------------------------------------------------------
+
+int SparseIntSet::nextWord(int i, uint64_t& bits) const
+{
+    //start in i's chunk (or the next one), then take the first word with
+    //values; chunks are never empty, so at most one chunk is passed over
+    int key = i / CHUNK_WORDS;
+    for (int k = chunkAtOrAfter(key); k < (int)chunks.size(); k++)
+    {
+        int start = (chunks[k].key == key) ? i % CHUNK_WORDS : 0;
+        int local = chunkNextWord(chunks[k], start, bits);
+        if (local != -1)
+        {
+            return chunks[k].key * CHUNK_WORDS + local;
+        }
+    }
+    return -1;
+}
+
+//---------------------------------------------------------------------------
+
+int SparseIntSet::findChunk(int key) const
+{
+    //binary search over the sorted chunk keys
+    int low = 0;
+    int high = (int)chunks.size() - 1;
+    while (low <= high)
+    {
+        int mid = (low + high) / 2;
+        if (chunks[mid].key == key)
+        {
+            return mid;
+        }
+        else if (chunks[mid].key < key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    return -1;
+}
+
+//---------------------------------------------------------------------------
+
+int SparseIntSet::chunkAtOrAfter(int key) const
+{
+    //binary search for the first key that is not smaller
+    int low = 0;
+    int high = (int)chunks.size();
+    while (low < high)
+    {
+        int mid = (low + high) / 2;
+        if (chunks[mid].key < key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+//---------------------------------------------------------------------------
+
+int SparseIntSet::changeRange(int lo, int hi, bool set)
+{
+    //an empty range has no last value to build the masks from
+    if (lo >= hi)
+    {
+        return 0;
+    }
+
+    //the chunks are rebuilt in a new list, so chunks added inside the
+    //range cost no shifting of the ones after them
+    vector<Chunk> result;
+    result.reserve(chunks.size());
+    size_t i = 0;
+    int firstKey = lo >> CHUNK_BITS;
+    int lastKey = (hi - 1) >> CHUNK_BITS;
+
+    //chunks before the range are kept as they are
+    while (i < chunks.size() && chunks[i].key < firstKey)
+    {
+        result.push_back(std::move(chunks[i++]));
+    }
+
+    //each chunk in the range is expanded to a bitmap, changed a word at a
+    //time, and stored again in its smallest form
+    int changed = 0;
+    vector<uint64_t> bits(CHUNK_WORDS);
+    for (int key = firstKey; key <= lastKey; key++)
+    {
+        bool exists = i < chunks.size() && chunks[i].key == key;
+        if (!exists && !set)
+        {
+            continue;
+        }
+
+        Chunk chunk;
+        if (exists)
+        {
+            chunk = std::move(chunks[i++]);
+            chunkToBits(chunk, bits.data());
+        }
+        else
+        {
+            chunk.key = key;
+            fill(bits.begin(), bits.end(), uint64_t(0));
+        }
+
+        //the part of the range inside this chunk, as low bits
+        int base = key << CHUNK_BITS;
+        int first = max(lo, base) - base;
+        int last = min(hi - 1, base + (CHUNK_VALUES - 1)) - base;
+        for (int w = first / 64; w <= last / 64; w++)
+        {
+            int from = (w == first / 64) ? first % 64 : 0;
+            int to = (w == last / 64) ? last % 64 : 63;
+            uint64_t mask = (~uint64_t(0) >> (63 - (to - from))) << from;
+            if (set)
+            {
+                changed += popcount64(mask & ~bits[w]);
+                bits[w] |= mask;
+            }
+            else
+            {
+                changed += popcount64(mask & bits[w]);
+                bits[w] &= ~mask;
+            }
+        }
+
+        chunkFromBits(chunk, bits.data());
+        if (chunk.cardinality > 0)
+        {
+            result.push_back(std::move(chunk));
+        }
+    }
+
+    //chunks after the range are kept as they are
+    while (i < chunks.size())
+    {
+        result.push_back(std::move(chunks[i++]));
+    }
+
+    chunks.swap(result);
+    return changed;
+}
+
+//---------------------------------------------------------------------------
+// Chunk helpers
+
+//chunkContains()
+//checks whether the low bits are in the chunk
+bool SparseIntSet::chunkContains(const Chunk& chunk, int low)
+{
+    if (chunk.type == ARRAY_CHUNK)
+    {
+        return binary_search(chunk.values.begin(), chunk.values.end(),
+            (uint16_t)low);
+    }
+
+    if (chunk.type == BITMAP_CHUNK)
+    {
+        return ((chunk.bits[low / 64] >> (low % 64)) & 1) != 0;
+    }
+
+    //runs: find the last run starting at or before the value
+    int lowRun = 0;
+    int highRun = (int)chunk.runs.size() / 2 - 1;
+    while (lowRun <= highRun)
+    {
+        int mid = (lowRun + highRun) / 2;
+        if (chunk.runs[2 * mid] > low)
+        {
+            highRun = mid - 1;
+        }
+        else if (chunk.runs[2 * mid + 1] < low)
+        {
+            lowRun = mid + 1;
+        }
+        else
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//chunkInsert()
+//adds the low bits to the chunk; returns true if they were not there yet
+bool SparseIntSet::chunkInsert(Chunk& chunk, int low)
+{
+    if (chunk.type == ARRAY_CHUNK)
+    {
+        vector<uint16_t>::iterator pos = lower_bound(chunk.values.begin(),
+            chunk.values.end(), (uint16_t)low);
+        if (pos != chunk.values.end() && *pos == low)
+        {
+            return false;
+        }
+        chunk.values.insert(pos, (uint16_t)low);
+        chunk.cardinality++;
+
+        //an array past the limit is larger than a bitmap
+        if (chunk.cardinality > ARRAY_LIMIT)
+        {
+            arrayToBitmap(chunk);
+        }
+        return true;
+    }
+
+    if (chunk.type == BITMAP_CHUNK)
+    {
+        uint64_t bit = uint64_t(1) << (low % 64);
+        if ((chunk.bits[low / 64] & bit) != 0)
+        {
+            return false;
+        }
+        chunk.bits[low / 64] |= bit;
+        chunk.cardinality++;
+        return true;
+    }
+
+    //runs: find the index of the last run starting at or before the value
+    int runCount = (int)chunk.runs.size() / 2;
+    int i = -1;
+    while (i + 1 < runCount && chunk.runs[2 * (i + 1)] <= low)
+    {
+        i++;
+    }
+
+    //already inside a run
+    if (i >= 0 && low <= chunk.runs[2 * i + 1])
+    {
+        return false;
+    }
+
+    bool extendsPrev = (i >= 0 && chunk.runs[2 * i + 1] + 1 == low);
+    bool extendsNext = (i + 1 < runCount && chunk.runs[2 * (i + 1)] == low + 1);
+    if (extendsPrev && extendsNext)
+    {
+        //value closes the gap between two runs: merge them
+        chunk.runs[2 * i + 1] = chunk.runs[2 * (i + 1) + 1];
+        chunk.runs.erase(chunk.runs.begin() + 2 * (i + 1),
+            chunk.runs.begin() + 2 * (i + 2));
+    }
+    else if (extendsPrev)
+    {
+        chunk.runs[2 * i + 1] = (uint16_t)low;
+    }
+    else if (extendsNext)
+    {
+        chunk.runs[2 * (i + 1)] = (uint16_t)low;
+    }
+    else
+    {
+        //start a new run of one value
+        uint16_t run[2] = { (uint16_t)low, (uint16_t)low };
+        chunk.runs.insert(chunk.runs.begin() + 2 * (i + 1), run, run + 2);
+    }
+    chunk.cardinality++;
+
+    //too many runs: a bitmap is smaller
+    if (chunk.runs.size() * sizeof(uint16_t) > CHUNK_WORDS * sizeof(uint64_t))
+    {
+        vector<uint64_t> bits(CHUNK_WORDS);
+        chunkToBits(chunk, bits.data());
+        chunkFromBits(chunk, bits.data());
+    }
+    return true;
+}
+
+//chunkRemove()
+//removes the low bits from the chunk; returns true if they were there
+bool SparseIntSet::chunkRemove(Chunk& chunk, int low)
+{
+    if (chunk.type == ARRAY_CHUNK)
+    {
+        vector<uint16_t>::iterator pos = lower_bound(chunk.values.begin(),
+            chunk.values.end(), (uint16_t)low);
+        if (pos == chunk.values.end() || *pos != low)
+        {
+            return false;
+        }
+        chunk.values.erase(pos);
+        chunk.cardinality--;
+        return true;
+    }
+
+    if (chunk.type == BITMAP_CHUNK)
+    {
+        uint64_t bit = uint64_t(1) << (low % 64);
+        if ((chunk.bits[low / 64] & bit) == 0)
+        {
+            return false;
+        }
+        chunk.bits[low / 64] &= ~bit;
+        chunk.cardinality--;
+
+        //a small enough bitmap is larger than the array would be
+        if (chunk.cardinality <= ARRAY_LIMIT)
+        {
+            bitmapToArray(chunk);
+        }
+        return true;
+    }
+
+    //runs: find the run holding the value
+    int runCount = (int)chunk.runs.size() / 2;
+    int i = 0;
+    while (i < runCount && chunk.runs[2 * i + 1] < low)
+    {
+        i++;
+    }
+    if (i == runCount || chunk.runs[2 * i] > low)
+    {
+        return false;
+    }
+
+    int start = chunk.runs[2 * i];
+    int last = chunk.runs[2 * i + 1];
+    if (start == last)
+    {
+        //run of one value disappears
+        chunk.runs.erase(chunk.runs.begin() + 2 * i,
+            chunk.runs.begin() + 2 * (i + 1));
+    }
+    else if (low == start)
+    {
+        chunk.runs[2 * i] = (uint16_t)(low + 1);
+    }
+    else if (low == last)
+    {
+        chunk.runs[2 * i + 1] = (uint16_t)(low - 1);
+    }
+    else
+    {
+        //value splits the run in two
+        chunk.runs[2 * i + 1] = (uint16_t)(low - 1);
+        uint16_t run[2] = { (uint16_t)(low + 1), (uint16_t)last };
+        chunk.runs.insert(chunk.runs.begin() + 2 * (i + 1), run, run + 2);
+    }
+    chunk.cardinality--;
+    return true;
+}
+
+//chunkMax()
+//returns the largest low bits held by a non-empty chunk
+int SparseIntSet::chunkMax(const Chunk& chunk)
+{
+    if (chunk.type == ARRAY_CHUNK)
+    {
+        return chunk.values.back();
+    }
+
+    if (chunk.type == RUN_CHUNK)
+    {
+        return chunk.runs.back();
+    }
+
+    //bitmap: highest word that is not zero, then its highest bit
+    int i = CHUNK_WORDS - 1;
+    while (chunk.bits[i] == 0)
+    {
+        i--;
+    }
+    int bit = 63;
+    while (((chunk.bits[i] >> bit) & 1) == 0)
+    {
+        bit--;
+    }
+    return i * 64 + bit;
+}
+
+//chunkBytes()
+//returns the number of bytes held by the chunk's container
+size_t SparseIntSet::chunkBytes(const Chunk& chunk)
+{
+    return chunk.values.capacity() * sizeof(uint16_t) +
+        chunk.bits.capacity() * sizeof(uint64_t) +
+        chunk.runs.capacity() * sizeof(uint16_t);
+}
+
+//chunkToBits()
+//fills a CHUNK_WORDS bitmap with the values of the chunk
+void SparseIntSet::chunkToBits(const Chunk& chunk, uint64_t* bits)
+{
+    if (chunk.type == BITMAP_CHUNK)
+    {
+        copy(chunk.bits.begin(), chunk.bits.end(), bits);
+        return;
+    }
+
+    fill(bits, bits + CHUNK_WORDS, uint64_t(0));
+    if (chunk.type == ARRAY_CHUNK)
+    {
+        for (size_t i = 0; i < chunk.values.size(); i++)
+        {
+            int low = chunk.values[i];
+            bits[low / 64] |= uint64_t(1) << (low % 64);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < chunk.runs.size(); i += 2)
+    {
+        for (int low = chunk.runs[i]; low <= chunk.runs[i + 1]; low++)
+        {
+            bits[low / 64] |= uint64_t(1) << (low % 64);
+        }
+    }
+}
+
+//chunkFromBits()
+//stores the bitmap in the chunk using whichever form is smallest
+void SparseIntSet::chunkFromBits(Chunk& chunk, const uint64_t* bits)
+{
+    //count values and runs; a run starts at a set bit whose lower
+    //neighbour (carried over from the previous word) is clear
+    int cardinality = 0;
+    int runCount = 0;
+    uint64_t carry = 0;
+    for (int i = 0; i < CHUNK_WORDS; i++)
+    {
+        cardinality += popcount64(bits[i]);
+        runCount += popcount64(bits[i] & ~((bits[i] << 1) | carry));
+        carry = bits[i] >> 63;
+    }
+
+    size_t arrayBytes = cardinality * sizeof(uint16_t);
+    size_t runBytes = runCount * 2 * sizeof(uint16_t);
+    size_t bitmapBytes = CHUNK_WORDS * sizeof(uint64_t);
+
+    chunk.cardinality = cardinality;
+    vector<uint16_t>().swap(chunk.values);
+    vector<uint16_t>().swap(chunk.runs);
+
+    if (runBytes < arrayBytes && runBytes < bitmapBytes)
+    {
+        //runs: record where each run of set bits starts and ends
+        chunk.type = RUN_CHUNK;
+        chunk.runs.reserve(2 * runCount);
+        int low = 0;
+        while (low < CHUNK_VALUES)
+        {
+            if (((bits[low / 64] >> (low % 64)) & 1) == 0)
+            {
+                low++;
+                continue;
+            }
+            int start = low;
+            while (low < CHUNK_VALUES && ((bits[low / 64] >> (low % 64)) & 1))
+            {
+                low++;
+            }
+            chunk.runs.push_back((uint16_t)start);
+            chunk.runs.push_back((uint16_t)(low - 1));
+        }
+        vector<uint64_t>().swap(chunk.bits);
+    }
+    else if (cardinality <= ARRAY_LIMIT && arrayBytes <= bitmapBytes)
+    {
+        //array: walk the set bits of every word
+        chunk.type = ARRAY_CHUNK;
+        chunk.values.reserve(cardinality);
+        for (int i = 0; i < CHUNK_WORDS; i++)
+        {
+            uint64_t word = bits[i];
+            while (word != 0)
+            {
+                chunk.values.push_back((uint16_t)(i * 64 + ctz64(word)));
+                word &= word - 1;
+            }
+        }
+        vector<uint64_t>().swap(chunk.bits);
+    }
+    else
+    {
+        chunk.type = BITMAP_CHUNK;
+        chunk.bits.assign(bits, bits + CHUNK_WORDS);
+    }
+}
+
+//arrayToBitmap()
+//converts an array chunk into a bitmap chunk
+void SparseIntSet::arrayToBitmap(Chunk& chunk)
+{
+    chunk.bits.assign(CHUNK_WORDS, 0);
+    chunkToBits(chunk, chunk.bits.data());
+    chunk.type = BITMAP_CHUNK;
+    vector<uint16_t>().swap(chunk.values);
+}
+
+//bitmapToArray()
+//converts a bitmap chunk into an array chunk
+void SparseIntSet::bitmapToArray(Chunk& chunk)
+{
+    chunk.values.clear();
+    chunk.values.reserve(chunk.cardinality);
+    for (int i = 0; i < CHUNK_WORDS; i++)
+    {
+        uint64_t word = chunk.bits[i];
+        while (word != 0)
+        {
+            chunk.values.push_back((uint16_t)(i * 64 + ctz64(word)));
+            word &= word - 1;
+        }
+    }
+    chunk.type = ARRAY_CHUNK;
+    vector<uint64_t>().swap(chunk.bits);
+}
+
+//chunkEquals()
+//checks whether two chunks with the same key hold the same values
+bool SparseIntSet::chunkEquals(const Chunk& first, const Chunk& second)
+{
+    if (first.key != second.key || first.cardinality != second.cardinality)
+    {
+        return false;
+    }
+
+    //same form: compare the containers directly
+    if (first.type == second.type)
+    {
+        return first.values == second.values && first.bits == second.bits &&
+            first.runs == second.runs;
+    }
+
+    //different forms: compare as bitmaps
+    vector<uint64_t> a(CHUNK_WORDS), b(CHUNK_WORDS);
+    chunkToBits(first, a.data());
+    chunkToBits(second, b.data());
+    return a == b;
+}
+
+//chunkSubset()
+//checks whether every value of the first chunk is in the second
+bool SparseIntSet::chunkSubset(const Chunk& sub, const Chunk& super)
+{
+    if (sub.cardinality > super.cardinality)
+    {
+        return false;
+    }
+
+    //a small array is cheaper to look up value by value
+    if (sub.type == ARRAY_CHUNK)
+    {
+        for (size_t i = 0; i < sub.values.size(); i++)
+        {
+            if (!chunkContains(super, sub.values[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    vector<uint64_t> a(CHUNK_WORDS), b(CHUNK_WORDS);
+    chunkToBits(sub, a.data());
+    chunkToBits(super, b.data());
+    for (int i = 0; i < CHUNK_WORDS; i++)
+    {
+        if ((a[i] & ~b[i]) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//chunkUnion()
+//returns a chunk holding the values of both chunks
+SparseIntSet::Chunk SparseIntSet::chunkUnion(const Chunk& first,
+    const Chunk& second)
+{
+    Chunk result;
+    result.key = first.key;
+
+    //two arrays that stay small are merged directly
+    if (first.type == ARRAY_CHUNK && second.type == ARRAY_CHUNK &&
+        first.cardinality + second.cardinality <= ARRAY_LIMIT)
+    {
+        result.type = ARRAY_CHUNK;
+        set_union(first.values.begin(), first.values.end(),
+            second.values.begin(), second.values.end(),
+            back_inserter(result.values));
+        result.cardinality = (int)result.values.size();
+        return result;
+    }
+
+    vector<uint64_t> a(CHUNK_WORDS), b(CHUNK_WORDS);
+    chunkToBits(first, a.data());
+    chunkToBits(second, b.data());
+    for (int i = 0; i < CHUNK_WORDS; i++)
+    {
+        a[i] |= b[i];
+    }
+    chunkFromBits(result, a.data());
+    return result;
+}
+
+//chunkIntersection()
+//returns a chunk holding the values found in both chunks
+SparseIntSet::Chunk SparseIntSet::chunkIntersection(const Chunk& first,
+    const Chunk& second)
+{
+    Chunk result;
+    result.key = first.key;
+
+    //an array on either side bounds the result: filter it value by value
+    if (first.type == ARRAY_CHUNK || second.type == ARRAY_CHUNK)
+    {
+        const Chunk& small = (first.type == ARRAY_CHUNK) ? first : second;
+        const Chunk& other = (first.type == ARRAY_CHUNK) ? second : first;
+        result.type = ARRAY_CHUNK;
+        for (size_t i = 0; i < small.values.size(); i++)
+        {
+            if (chunkContains(other, small.values[i]))
+            {
+                result.values.push_back(small.values[i]);
+            }
+        }
+        result.cardinality = (int)result.values.size();
+        return result;
+    }
+
+    vector<uint64_t> a(CHUNK_WORDS), b(CHUNK_WORDS);
+    chunkToBits(first, a.data());
+    chunkToBits(second, b.data());
+    for (int i = 0; i < CHUNK_WORDS; i++)
+    {
+        a[i] &= b[i];
+    }
+    chunkFromBits(result, a.data());
+    return result;
+}
+
+//chunkDifference()
+//returns a chunk holding the values of the first chunk not in the second
+SparseIntSet::Chunk SparseIntSet::chunkDifference(const Chunk& first,
+    const Chunk& second)
+{
+    Chunk result;
+    result.key = first.key;
+
+    //an array on the left bounds the result: filter it value by value
+    if (first.type == ARRAY_CHUNK)
+    {
+        result.type = ARRAY_CHUNK;
+        for (size_t i = 0; i < first.values.size(); i++)
+        {
+            if (!chunkContains(second, first.values[i]))
+            {
+                result.values.push_back(first.values[i]);
+            }
+        }
+        result.cardinality = (int)result.values.size();
+        return result;
+    }
+
+    vector<uint64_t> a(CHUNK_WORDS), b(CHUNK_WORDS);
+    chunkToBits(first, a.data());
+    chunkToBits(second, b.data());
+    for (int i = 0; i < CHUNK_WORDS; i++)
+    {
+        a[i] &= ~b[i];
+    }
+    chunkFromBits(result, a.data());
+    return result;
+}
+
+//chunkNextWord()
+//finds the first of the chunk's CHUNK_WORDS words, from start on, that
+//holds values; returns its index in the chunk (or -1) and stores its bits
+int SparseIntSet::chunkNextWord(const Chunk& chunk, int start,
+    uint64_t& bits)
+{
+    if (chunk.type == BITMAP_CHUNK)
+    {
+        for (int w = start; w < CHUNK_WORDS; w++)
+        {
+            if (chunk.bits[w] != 0)
+            {
+                bits = chunk.bits[w];
+                return w;
+            }
+        }
+        return -1;
+    }
+
+    if (chunk.type == ARRAY_CHUNK)
+    {
+        //the first value from the start word decides the word; the values
+        //that follow in the same word are gathered into its bits
+        vector<uint16_t>::const_iterator pos = lower_bound(
+            chunk.values.begin(), chunk.values.end(), (uint16_t)(start * 64));
+        if (pos == chunk.values.end())
+        {
+            return -1;
+        }
+        int w = *pos / 64;
+        bits = 0;
+        while (pos != chunk.values.end() && *pos / 64 == w)
+        {
+            bits |= uint64_t(1) << (*pos % 64);
+            ++pos;
+        }
+        return w;
+    }
+
+    //runs: the first run ending at or after the start word decides the
+    //word; every run overlapping that word adds its part of the bits
+    size_t j = 0;
+    while (j < chunk.runs.size() && chunk.runs[j + 1] < start * 64)
+    {
+        j += 2;
+    }
+    if (j == chunk.runs.size())
+    {
+        return -1;
+    }
+    int w = max((int)chunk.runs[j], start * 64) / 64;
+    bits = 0;
+    while (j < chunk.runs.size() && chunk.runs[j] <= w * 64 + 63)
+    {
+        int from = max((int)chunk.runs[j], w * 64) - w * 64;
+        int to = min((int)chunk.runs[j + 1], w * 64 + 63) - w * 64;
+        bits |= (~uint64_t(0) >> (63 - (to - from))) << from;
+        j += 2;
+    }
+    return w;
+}
+
+//chunkRank()
+//returns the number of values in the chunk whose low bits are below low
+int SparseIntSet::chunkRank(const Chunk& chunk, int low)
+{
+    if (chunk.type == ARRAY_CHUNK)
+    {
+        return (int)(lower_bound(chunk.values.begin(), chunk.values.end(),
+            (uint16_t)low) - chunk.values.begin());
+    }
+
+    if (chunk.type == BITMAP_CHUNK)
+    {
+        int total = 0;
+        for (int w = 0; w < low / 64; w++)
+        {
+            total += popcount64(chunk.bits[w]);
+        }
+        uint64_t below = (uint64_t(1) << (low % 64)) - 1;
+        return total + popcount64(chunk.bits[low / 64] & below);
+    }
+
+    //runs: whole runs below low, and the part of the run holding low
+    int total = 0;
+    for (size_t j = 0; j < chunk.runs.size() && chunk.runs[j] < low; j += 2)
+    {
+        total += min((int)chunk.runs[j + 1], low - 1) - chunk.runs[j] + 1;
+    }
+    return total;
+}
+
+//chunkSelect()
+//returns the low bits of the k-th smallest value of the chunk
+int SparseIntSet::chunkSelect(const Chunk& chunk, int k)
+{
+    if (chunk.type == ARRAY_CHUNK)
+    {
+        return chunk.values[k];
+    }
+
+    if (chunk.type == BITMAP_CHUNK)
+    {
+        for (int w = 0; w < CHUNK_WORDS; w++)
+        {
+            int bits = popcount64(chunk.bits[w]);
+            if (k < bits)
+            {
+                return w * 64 + select64(chunk.bits[w], k);
+            }
+            k -= bits;
+        }
+        return -1;
+    }
+
+    //runs: skip whole runs until the one holding the k-th value
+    for (size_t j = 0; j < chunk.runs.size(); j += 2)
+    {
+        int length = chunk.runs[j + 1] - chunk.runs[j] + 1;
+        if (k < length)
+        {
+            return chunk.runs[j] + k;
+        }
+        k -= length;
+    }
+    return -1;
+}
+
+//---------------------------------------------------------------------------
+
+SparseIntSet operator+(const SparseIntSet& first, const SparseIntSet& second)
+{
+    SparseIntSet retVal;
+
+    //merge the two sorted chunk lists
+    size_t i = 0;
+    size_t j = 0;
+    while (i < first.chunks.size() || j < second.chunks.size())
+    {
+        if (j == second.chunks.size() ||
+            (i < first.chunks.size() &&
+             first.chunks[i].key < second.chunks[j].key))
+        {
+            retVal.chunks.push_back(first.chunks[i++]);
+        }
+        else if (i == first.chunks.size() ||
+            second.chunks[j].key < first.chunks[i].key)
+        {
+            retVal.chunks.push_back(second.chunks[j++]);
+        }
+        else
+        {
+            retVal.chunks.push_back(
+                SparseIntSet::chunkUnion(first.chunks[i++], second.chunks[j++]));
+        }
+    }
+
+    return retVal;
+}
+
+//---------------------------------------------------------------------------
+
+SparseIntSet operator*(const SparseIntSet& first, const SparseIntSet& second)
+{
+    SparseIntSet retVal;
+
+    //only keys present in both sets can hold common values
+    size_t i = 0;
+    size_t j = 0;
+    while (i < first.chunks.size() && j < second.chunks.size())
+    {
+        if (first.chunks[i].key < second.chunks[j].key)
+        {
+            i++;
+        }
+        else if (second.chunks[j].key < first.chunks[i].key)
+        {
+            j++;
+        }
+        else
+        {
+            SparseIntSet::Chunk chunk = SparseIntSet::chunkIntersection(
+                first.chunks[i++], second.chunks[j++]);
+            if (chunk.cardinality > 0)
+            {
+                retVal.chunks.push_back(chunk);
+            }
+        }
+    }
+
+    return retVal;
+}
+
+//---------------------------------------------------------------------------
+
+SparseIntSet operator-(const SparseIntSet& first, const SparseIntSet& second)
+{
+    SparseIntSet retVal;
+
+    //every chunk of first is kept, minus the matching chunk of second
+    size_t j = 0;
+    for (size_t i = 0; i < first.chunks.size(); i++)
+    {
+        while (j < second.chunks.size() &&
+            second.chunks[j].key < first.chunks[i].key)
+        {
+            j++;
+        }
+
+        if (j == second.chunks.size() ||
+            second.chunks[j].key != first.chunks[i].key)
+        {
+            retVal.chunks.push_back(first.chunks[i]);
+            continue;
+        }
+
+        SparseIntSet::Chunk chunk = SparseIntSet::chunkDifference(
+            first.chunks[i], second.chunks[j]);
+        if (chunk.cardinality > 0)
+        {
+            retVal.chunks.push_back(chunk);
+        }
+    }
+
+    return retVal;
+}
+
+//---------------------------------------------------------------------------
+
+istream& operator>>(istream& stream, SparseIntSet& intSet)
+{
+    //keep inserting into the set until -1 is read; a failed read (a
+    //non-integer, or the end of input before -1) leaves failbit set and
+    //stops the loop
+    int x = 0;
+    while (stream >> x && x != -1)
+    {
+        intSet.insert(x);
+    }
+
+    return stream;
+}
+
+//---------------------------------------------------------------------------
+
+ostream& operator<<(ostream& stream, const SparseIntSet& intSet)
+{
+    //opening curly bracket
+    stream << "{";
+
+    //space followed by each element of the set, chunk by chunk
+    for (size_t i = 0; i < intSet.chunks.size(); i++)
+    {
+        const SparseIntSet::Chunk& chunk = intSet.chunks[i];
+        int base = chunk.key << SparseIntSet::CHUNK_BITS;
+
+        if (chunk.type == SparseIntSet::ARRAY_CHUNK)
+        {
+            for (size_t j = 0; j < chunk.values.size(); j++)
+            {
+                stream << " " << base + chunk.values[j];
+            }
+        }
+        else if (chunk.type == SparseIntSet::BITMAP_CHUNK)
+        {
+            for (int w = 0; w < SparseIntSet::CHUNK_WORDS; w++)
+            {
+                uint64_t word = chunk.bits[w];
+                while (word != 0)
+                {
+                    stream << " " << base + w * 64 + ctz64(word);
+                    word &= word - 1;
+                }
+            }
+        }
+        else
+        {
+            for (size_t j = 0; j < chunk.runs.size(); j += 2)
+            {
+                for (int low = chunk.runs[j]; low <= chunk.runs[j + 1]; low++)
+                {
+                    stream << " " << base + low;
+                }
+            }
+        }
+    }
+
+    //closing curly bracket
+    stream << "}" << "\n";
+
+    return stream;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,238 @@
+//---------------------------------------------------------------------------
+// class SparseIntSet
+// Developer: Yash Varde
+//---------------------------------------------------------------------------
+// ADT SparseIntSet: a set of positive integers (zero inclusive) whose
+// memory tracks the number of members rather than the largest member
+// -- same operator surface as IntSet: union (+), intersection (*),
+//    difference (-), compound assignment, ==, !=, << and >>
+// -- suited to sets whose few members are spread over a wide range
+// -- IntSet keeps such sets in a SparseIntSet (its sparse mode), reading
+//    them through word() and nextWord() in the layout of its own words
+//
+// Implementation and Assumptions:
+// -- values are split into chunks of 65536 (the high 16 bits pick the chunk)
+// -- only chunks holding at least one value are stored, sorted by key
+// -- each chunk is stored in whichever form is smallest:
+//    -- array:  sorted 16-bit values (2 bytes per member, up to 4096)
+//    -- bitmap: 1024 64-bit words (8 KB no matter how many members)
+//    -- runs:   sorted [start, last] pairs (4 bytes per run of members)
+// -- set operators work chunk by chunk and pick the form of every result
+//    chunk again; insert/remove keep the current form unless an array
+//    outgrows 4096 values or a bitmap drops to 4096 values or fewer
+// -- getSize() is the largest member + 1 (0 when empty), as with IntSet
+// -- in <<, integers are preceded by a space, as with IntSet
+// -- in >>, integers are read until -1, as with IntSet
+//---------------------------------------------------------------------------
+#ifndef SPARSEINTSET_H
+#define SPARSEINTSET_H
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+class SparseIntSet
+{
+    // operator +
+    // Overloaded adding operator. Returns the union of two SparseIntSets.
+    // Preconditions: none
+    // Postconditions: the SparseIntSet parameters remain unchanged
+    friend SparseIntSet operator + (const SparseIntSet&, const SparseIntSet&);
+
+    // operator *
+    // Overloaded multiply operator. Returns the intersection of two sets.
+    // Preconditions: none
+    // Postconditions: the SparseIntSet parameters remain unchanged
+    friend SparseIntSet operator * (const SparseIntSet&, const SparseIntSet&);
+
+    // operator -
+    // Overloaded minus operator. Returns elements in first and not in second
+    // Preconditions: none
+    // Postconditions: the SparseIntSet parameters remain unchanged
+    friend SparseIntSet operator - (const SparseIntSet&, const SparseIntSet&);
+
+    // operator >>
+    // Overloaded input operator. Inputs values until -1 is read.
+    // Preconditions: the SparseIntSet reference must already be declared.
+    // Postconditions: the SparseIntSet contains the ints that were input;
+    //                 anything else (or the end of input) before the -1
+    //                 stops the read and sets failbit
+    friend istream& operator >> (istream&, SparseIntSet&);
+
+    // operator <<
+    // Overloaded output operator. Outputs values within the set.
+    // Preconditions: none
+    // Postconditions: the SparseIntSet parameter remains unchanged
+    friend ostream& operator << (ostream&, const SparseIntSet&);
+
+public:
+    // Constructor with int parameters
+    // Allows for up to five int arguments to be inserted by user.
+    // Preconditions: only integers should be entered to work properly.
+    // Postconditions: a SparseIntSet containing the ints is instantiated.
+    // (copying, assignment and destruction are handled by the chunk vector)
+    SparseIntSet(int = -1, int = -1, int = -1, int = -1, int = -1);
+
+    // operator +=, *=, -=
+    // modifies current object to be the union, intersection or difference
+    // of itself and the other
+    // Preconditions: none
+    // Postconditions: "this" SparseIntSet holds the result
+    SparseIntSet& operator += (const SparseIntSet&);
+    SparseIntSet& operator *= (const SparseIntSet&);
+    SparseIntSet& operator -= (const SparseIntSet&);
+
+    // operator ==, !=
+    // Checks whether two SparseIntSets hold the same values
+    // Preconditions: none
+    // Postconditions: both SparseIntSets remain unchanged
+    bool operator == (const SparseIntSet&) const;
+    bool operator != (const SparseIntSet&) const;
+
+    // insert()
+    // inserts the supplied integer into the set
+    // Preconditions: none
+    // Postconditions: returns false for negative values, true otherwise
+    bool insert(int);
+
+    // remove()
+    // removes the supplied integer from the set
+    // Preconditions: none
+    // Postconditions: returns true if the value was in the set
+    bool remove(int);
+
+    // isEmpty()
+    // checks whether the set holds no values
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    bool isEmpty() const;
+
+    // isInSet()
+    // Checks whether the given int is within the set
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    bool isInSet(int) const;
+
+    // containsSet()
+    // Checks whether every value of the given set is within this set
+    // Preconditions: none
+    // Postconditions: both sets remain unchanged
+    bool containsSet(const SparseIntSet&) const;
+
+    // operator []
+    // Same as isInSet()
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    bool operator [] (int) const;
+
+    // getSize()
+    // Returns the largest value in the set + 1, or 0 when it is empty
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    int getSize() const;
+
+    // count()
+    // Returns the number of values in the set
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    int count() const;
+
+    // memoryUsage()
+    // Returns the number of bytes used by the chunk containers
+    // Preconditions: none
+    // Postconditions: does not modify the set
+    size_t memoryUsage() const;
+
+    // insertRange(), removeRange()
+    // insert or remove every value from lo to hi - 1, a chunk at a time
+    // Preconditions: none
+    // Postconditions: insertRange returns false (set unchanged) if lo is
+    //                 negative or hi < lo; removeRange returns true if any
+    //                 values were removed
+    bool insertRange(int, int);
+    bool removeRange(int, int);
+
+    // rank(), select()
+    // Return the number of values smaller than x, and the k-th smallest
+    // value (k = 0 is the smallest)
+    // Preconditions: none
+    // Postconditions: select returns -1 if k is not below count()
+    int rank(int) const;
+    int select(int) const;
+
+    // assignWords()
+    // Replaces the set with the values of a bit array, where bit b of
+    // word w stands for the value w * 64 + b (the layout of IntSet's words)
+    // Preconditions: the array must hold the given number of words
+    // Postconditions: each chunk is stored in its smallest form
+    void assignWords(const uint64_t*, int);
+
+    // word(), nextWord()
+    // Return word i of the set laid out as such a bit array. nextWord()
+    // finds the first word at or after i that holds values: it returns the
+    // word's index (or -1 if there is none) and stores its bits.
+    // Preconditions: the index must not be negative
+    // Postconditions: does not modify the set
+    uint64_t word(int) const;
+    int nextWord(int, uint64_t&) const;
+
+private:
+    static const int CHUNK_BITS = 16;               //low bits kept per chunk
+    static const int CHUNK_VALUES = 1 << CHUNK_BITS;//values per chunk
+    static const int CHUNK_WORDS = CHUNK_VALUES / 64;//words in a bitmap
+    static const int ARRAY_LIMIT = 4096;            //largest array chunk
+
+    //ChunkType
+    //the three forms a chunk can be stored in
+    enum ChunkType { ARRAY_CHUNK, BITMAP_CHUNK, RUN_CHUNK };
+
+    //Chunk
+    //holds the values of the set whose high 16 bits equal the key. Only the
+    //vector matching the type is in use; the others are empty.
+    struct Chunk
+    {
+        int key;                        //high 16 bits of every value
+        ChunkType type;                 //form the values are stored in
+        int cardinality;                //number of values in the chunk
+        vector<uint16_t> values;        //ARRAY_CHUNK: sorted low bits
+        vector<uint64_t> bits;          //BITMAP_CHUNK: one bit per value
+        vector<uint16_t> runs;          //RUN_CHUNK: [start, last] pairs
+    };
+
+    vector<Chunk> chunks;               //non-empty chunks sorted by key
+
+    // findChunk()
+    // Returns the index of the chunk with the given key, or -1
+    int findChunk(int) const;
+
+    // chunkAtOrAfter()
+    // Returns the index of the first chunk whose key is at least the given
+    // key, or the number of chunks if there is none
+    int chunkAtOrAfter(int) const;
+
+    // changeRange()
+    // Sets (or clears) the values from lo to hi - 1; returns how many
+    // values were added (or removed), which is 0 for an empty range
+    int changeRange(int, int, bool);
+
+    // Chunk helpers (static: they only look at the chunks passed in)
+    static bool chunkContains(const Chunk&, int);
+    static bool chunkInsert(Chunk&, int);
+    static bool chunkRemove(Chunk&, int);
+    static int chunkMax(const Chunk&);
+    static size_t chunkBytes(const Chunk&);
+    static void chunkToBits(const Chunk&, uint64_t*);
+    static void chunkFromBits(Chunk&, const uint64_t*);
+    static void arrayToBitmap(Chunk&);
+    static void bitmapToArray(Chunk&);
+    static bool chunkEquals(const Chunk&, const Chunk&);
+    static bool chunkSubset(const Chunk&, const Chunk&);
+    static Chunk chunkUnion(const Chunk&, const Chunk&);
+    static Chunk chunkIntersection(const Chunk&, const Chunk&);
+    static Chunk chunkDifference(const Chunk&, const Chunk&);
+    static int chunkNextWord(const Chunk&, int, uint64_t&);
+    static int chunkRank(const Chunk&, int);
+    static int chunkSelect(const Chunk&, int);
+};
+#endif
@@ -1,4 +1,6 @@
 #include "bintree.h"
+#include <algorithm>
+#include <new>
 
 //---------------------------------------------------------------------------
 //default constructor
@@ -43,8 +45,9 @@ BinTree& BinTree::operator=(const BinTree& source)
         return *this;
     }
 
-    //delete elements from "this" tree
+    //delete elements from "this" tree, and take the source's mode
     makeEmpty();
+    balanced = source.balanced;
     
     //check whether source tree is empty
     if (source.isEmpty())
@@ -59,32 +62,41 @@ BinTree& BinTree::operator=(const BinTree& source)
 }
 
 //copy
-//helper for overloaded operator ==
-//copies from the source node to the destination node including children
+//helper for overloaded operator =
+//copies the source subtree, returning the new subtree as dest. Walks the
+//source with an explicit stack of (source node, link to fill in) pairs.
 BinTree::Node* BinTree::copy(Node* source, Node* dest)
 {
-    //if source node is empty, dest node should also be empty
-    if (source == nullptr)
-    {
-        dest = nullptr;
-    }
-    else
+    //each pending node is paired with the link that should point at its copy
+    dest = nullptr;
+    vector<pair<Node*, Node**>> pending;
+    pending.push_back(make_pair(source, &dest));
+
+    while (!pending.empty())
     {
-        //copy the root node
-        dest = new Node;
-        
-        if (source->data != nullptr)
+        Node* from = pending.back().first;
+        Node** link = pending.back().second;
+        pending.pop_back();
+
+        //if source node is empty, dest node should also be empty
+        if (from == nullptr)
         {
-            NodeData* newData = new NodeData;
-            *newData = *source->data;
-            dest->data = newData;
+            *link = nullptr;
+            continue;
         }
 
-        //copy the left subtree
-        dest->left = copy(source->left, dest->left);
+        //copy the node, then its left and right subtrees
+        Node* to = newNode(nullptr, false);
+        if (from->data != nullptr)
+        {
+            to->data = newData(*from->data);
+            to->pooled = true;
+        }
+        to->height = from->height;
+        *link = to;
 
-        //copy the right subtree
-        dest->right = copy(source->right, dest->right);
+        pending.push_back(make_pair(from->right, &to->right));
+        pending.push_back(make_pair(from->left, &to->left));
     }
 
     //return the value of dest node
@@ -111,34 +123,37 @@ bool BinTree::operator==(const BinTree& other) const
 
 //compareTrees()
 //helper function for overloaded operator ==
-//checks whether two nodes and their children are equal
+//checks whether two nodes and their children are equal, walking both trees
+//together with an explicit stack of node pairs
 bool BinTree::compareTrees(Node* first, Node* second) const
 {
-    //check whether both trees are null. This means that they are equal
-    if (first == nullptr && second == nullptr)
-    {
-        return true;
-    }
-
-    //one of the two trees is null, not both -> they are not equal
-    else if (first == nullptr || second == nullptr)
-    {
-        return false;
-    }
+    vector<pair<Node*, Node*>> pending;
+    pending.push_back(make_pair(first, second));
 
-    else //both trees are not null and need to be compared further
+    while (!pending.empty())
     {
-        //compare the roots
-        bool equalRoots = (*(first->data) == *(second->data));
+        Node* a = pending.back().first;
+        Node* b = pending.back().second;
+        pending.pop_back();
 
-        //compare the left subtrees
-        bool leftSubtreesEqual = compareTrees(first->left, second->left);
+        //check whether both subtrees are null. This means that they are equal
+        if (a == nullptr && b == nullptr)
+        {
+            continue;
+        }
 
-        //compare the right subtrees
-        bool rightSubtreesEqual = compareTrees(first->right, second->right);
+        //one of the two is null, not both, or the roots differ -> not equal
+        if (a == nullptr || b == nullptr || *(a->data) != *(b->data))
+        {
+            return false;
+        }
 
-        return equalRoots && leftSubtreesEqual && rightSubtreesEqual;
+        //compare the left subtrees, then the right subtrees
+        pending.push_back(make_pair(a->right, b->right));
+        pending.push_back(make_pair(a->left, b->left));
     }
+
+    return true;
 }
 
 //---------------------------------------------------------------------------
@@ -163,7 +178,8 @@ bool BinTree::retrieve(const NodeData& target, NodeData*& actual) const
 
 bool BinTree::retrieveHelper(const NodeData& target, NodeData*& actual, BinTree::Node* root) const
 {
-    if (root != nullptr && root->data != nullptr)
+    //walk down one branch: left if target is less, right if greater
+    while (root != nullptr && root->data != nullptr)
     {
         //check whether target is at the root
         if (target == *(root->data))
@@ -173,20 +189,10 @@ bool BinTree::retrieveHelper(const NodeData& target, NodeData*& actual, BinTree:
             return true;
         }
 
-        //search the left subtree if target is less than root
-        if (target < *(root->data))
-        {
-            return retrieveHelper(target, actual, root->left);
-        }
-
-        //search the right subtree if target is greater than root
-        if (target > *(root->data))
-        {
-            return retrieveHelper(target, actual, root->right);
-        }
+        root = (target < *(root->data)) ? root->left : root->right;
     }
 
-    //root->data is a null pointer
+    //target is not in the tree
     return false;
 }
 
@@ -211,13 +217,42 @@ if (*ptr->data < *current->data)
     // Memory is fully allocated and inititalized
  */
 bool BinTree::insert(NodeData* ND) {
+    return insertData(ND, false);
+}
+
+//---------------------------------------------------------------------------
+//insertCopy()
+//inserts a copy of the NodeData, stored in the tree's own arena
+//Preconditions: NodeData must not have an empty string
+//Postconditions: returns true if the copy was inserted successfully
+bool BinTree::insertCopy(const NodeData& nd)
+{
+    //copy first: a duplicate's copy is destroyed again straight away
+    NodeData* copy = newData(nd);
+    if (insertData(copy, true))
+    {
+        return true;
+    }
+
+    freeData(copy, true);
+    return false;
+}
+
+//insertData()
+//helper for insert and insertCopy: the insert routine described above.
+//pooled says whether ND lives in dataSlab rather than on the heap.
+bool BinTree::insertData(NodeData* ND, bool pooled) {
     bool inserted = false;                    // whether inserted yet
 
+    // balanced mode inserts recursively so every node on the path can be
+    // rebalanced on the way back up
+    if (balanced) {
+        root = insertBalanced(root, ND, pooled, inserted);
+        return inserted;
+    }
+
     if (isEmpty()) {
-        root = new Node;
-        root->data = ND;
-        root->left = nullptr;
-        root->right = nullptr;
+        root = newNode(ND, pooled);
         inserted = true;
     }
     else {
@@ -231,10 +266,7 @@ bool BinTree::insert(NodeData* ND) {
 
             if (*ND < *current->data) {
                 if (current->left == nullptr) {     // insert left
-                    current->left = new Node;
-                    current->left->data = ND;
-                    current->left->left = nullptr;
-                    current->left->right = nullptr;
+                    current->left = newNode(ND, pooled);
                     inserted = true;
                 }
                 else
@@ -242,10 +274,7 @@ bool BinTree::insert(NodeData* ND) {
             }
             else if (*ND > *current->data) {
                 if (current->right == nullptr) {    // insert right
-                    current->right = new Node;
-                    current->right->data = ND;
-                    current->right->left = nullptr;
-                    current->right->right = nullptr;
+                    current->right = newNode(ND, pooled);
                     inserted = true;
                 }
                 else
@@ -278,37 +307,35 @@ bool BinTree::remove(const NodeData& target, NodeData*& actual)
 
 BinTree::Node* BinTree::removeHelper(const NodeData& target, NodeData*& actual, Node* root)
 {
-    //cannot delete from an empty tree
-    if (root == nullptr)
+    //find the link to the target's node, remembering the links passed
+    vector<Node**> path;
+    Node** link = &root;
+    while (*link != nullptr && *(*link)->data != target)
     {
-        actual = nullptr;
-        return root;
+        path.push_back(link);
+        link = (target < *(*link)->data) ? &(*link)->left : &(*link)->right;
     }
 
-    //keep track of the current node
-    NodeData current = *(root->data);
-
-    //check right subtree if target is greater than current node
-    if (target > current)
+    //target is not in the tree
+    if (*link == nullptr)
     {
-        root->right = removeHelper(target, actual, root->right);
+        actual = nullptr;
+        return root;
     }
 
-    //check left subtree if target is less than current node
-    else if (target < current)
-    {
-        root->left = removeHelper(target, actual, root->left);
-    }
+    //copy node into "actual", then delete it and rejoin the tree
+    actual = new NodeData(*(*link)->data);
+    *link = removeNode(*link);
 
-    //copy node into "actual" and delete it if the target is equal to the current node
-    else
+    //in balanced mode, every node on the search path is rebalanced
+    if (balanced)
     {
-        //copying
-        actual = new NodeData();
-        *actual = *root->data;
-
-        //deleting
-        root = removeNode(root);
+        *link = rebalance(*link);
+        while (!path.empty())
+        {
+            *path.back() = rebalance(*path.back());
+            path.pop_back();
+        }
     }
 
     return root;
@@ -328,18 +355,11 @@ BinTree::Node* BinTree::removeNode(Node*& node)
     }
     else if (node->left != nullptr && node->right != nullptr)
     {
-        //find predecessor
-        Node* parent;
-        temp = predecessor(node, parent);
-        if (node->right != temp)
-        {
-            temp->right = node->right;
-        }
-        if (node->left != temp)
-        {
-            temp->left = node->left;
-        }
-        parent->right = nullptr;
+        //detach the predecessor (max of the left subtree) and put it in
+        //place of the node
+        Node* left = removeMax(node->left, temp);
+        temp->left = left;
+        temp->right = node->right;
     }
 
     //node has a left child
@@ -354,34 +374,41 @@ BinTree::Node* BinTree::removeNode(Node*& node)
         temp = node->right;
     }
 
-    delete node->data;
-    delete node;
+    deleteNode(node);
     node = nullptr;
     return temp;
 }
 
-//predecessor
+//removeMax
 //helper function for removeNode
-//retrieves the max element in the left child of a particular node 
-BinTree::Node* BinTree::predecessor(Node* root, Node*& parent) const
+//detaches the max node of the given subtree (the predecessor of the
+//subtree's parent) and returns the remaining subtree
+BinTree::Node* BinTree::removeMax(Node* node, Node*& max)
 {
-    Node* subtreeRoot = root;
-
-    //find the left child of the given node
-    if (root != nullptr)
+    //follow right links to the max node, remembering the links passed
+    vector<Node**> path;
+    Node** link = &node;
+    while ((*link)->right != nullptr)
     {
-        parent = root;
-        subtreeRoot = root->left;
+        path.push_back(link);
+        link = &(*link)->right;
+    }
+
+    //the max node has no right child: its left subtree takes its place
+    max = *link;
+    *link = max->left;
 
-        //find max node in tree with subtreeRoot as the root
-        while (subtreeRoot->right != nullptr)
+    //in balanced mode, the nodes above it are rebalanced
+    if (balanced)
+    {
+        while (!path.empty())
         {
-            parent = subtreeRoot;
-            subtreeRoot = subtreeRoot->right;
+            *path.back() = rebalance(*path.back());
+            path.pop_back();
         }
     }
 
-    return subtreeRoot;
+    return node;
 }
 
 //---------------------------------------------------------------------------
@@ -391,7 +418,16 @@ BinTree::Node* BinTree::predecessor(Node* root, Node*& parent) const
 //Postconditions: returns true if the sibling could be found
 bool BinTree::getSibling(const NodeData& data, NodeData& copy) const
 {
-    Node* sibling = getSiblingHelper(root, data);
+    //the root has no parent and so no sibling
+    Node* parent = nullptr;
+    Node* node = findParent(data, parent);
+    if (node == nullptr || parent == nullptr)
+    {
+        return false;
+    }
+
+    //the sibling is the parent's other child, if it has one
+    Node* sibling = (parent->left == node) ? parent->right : parent->left;
     if (sibling != nullptr)
     {
         copy = *sibling->data;
@@ -400,45 +436,6 @@ bool BinTree::getSibling(const NodeData& data, NodeData& copy) const
     return sibling != nullptr;
 }
 
-BinTree::Node* BinTree::getSiblingHelper(Node* node, NodeData key) const
-{
-    //no sibling exists for a null node or the root of a binary tree
-    if (node == nullptr || *node->data == key)
-    {
-        return nullptr;
-    }
-
-    //return right node if the left node contains the key
-    if (node->left != nullptr && *(node->left)->data == key)
-    {
-        return node->right;
-    }
-
-    //return left node if the right node contains the key
-    if (node->right != nullptr && *(node->right)->data == key)
-    {
-        return node->left;
-    }
-
-    else //key does not exist in either children
-    {
-        //try finding a sibling within the left subtree with the key
-        Node* n = getSiblingHelper(node->left, key);
-
-        //check whether key exists there
-        if (n != nullptr)
-        {
-            return n;
-        }
-
-        //otherwise, check the right subtree
-        n = getSiblingHelper(node->left, key);
-
-        //nothing further can be done -> return even if null
-        return n;
-    }
-}
-
 //---------------------------------------------------------------------------
 //getParent()
 //finds the parent of a particular node if it exists
@@ -446,49 +443,34 @@ BinTree::Node* BinTree::getSiblingHelper(Node* node, NodeData key) const
 //Postconditions: returns true if the parent could be retrieved
 bool BinTree::getParent(const NodeData& data, NodeData& copy) const
 {
-    Node* parent = getParentHelper(root, data);
+    Node* parent = nullptr;
+    Node* node = findParent(data, parent);
 
-    if (parent != nullptr)
+    //no parent exists for a missing node or the root of the tree
+    if (node != nullptr && parent != nullptr)
     {
         copy = *parent->data;
     }
 
-    return parent != nullptr;
+    return node != nullptr && parent != nullptr;
 }
 
-BinTree::Node* BinTree::getParentHelper(Node* node, NodeData key) const
+//findParent()
+//helper function for getSibling and getParent
+//follows the search path to the node holding the key; returns the node (or
+//null if the key is not in the tree) and sets parent to its parent (null
+//for the root)
+BinTree::Node* BinTree::findParent(const NodeData& key, Node*& parent) const
 {
-    //no parent exists for a null node or the root of a binary tree
-    if (node == nullptr || *node->data == key)
-    {
-        return nullptr;
-    }
-
-    //return node if either right or left child matches the key
-    bool leftMatches = node->left != nullptr && *(node->left)->data == key;
-    bool rightMatches = node->right != nullptr && *(node->right)->data == key;
-    if (leftMatches || rightMatches)
+    Node* node = root;
+    parent = nullptr;
+    while (node != nullptr && *node->data != key)
     {
-        return node;
+        parent = node;
+        node = (key < *node->data) ? node->left : node->right;
     }
 
-    else //key does not exist in either child node
-    {
-        //try finding the parent within the left subtree
-        Node* n = getParentHelper(node->left, key);
-
-        //check whether key exists there
-        if (n != nullptr)
-        {
-            return n;
-        }
-
-        //otherwise, check the right subtree
-        n = getParentHelper(node->left, key);
-
-        //nothing further can be done -> return even if null
-        return n;
-    }
+    return node;
 }
 
 //---------------------------------------------------------------------------
@@ -516,27 +498,32 @@ void BinTree::bstreeToArray(NodeData* arr[])
     makeEmpty();
 }
 
-//arrayToBSTree()
-//creates a balanced tree from the provided array
-//Preconditions: array must be SORTED
-//Postconditions: array contains null pointers, and tree contains elements
+//bstreeToArrayHelper()
+//helper function for bstreeToArray
+//copies the data of a subtree into the array in order, starting at index i
 void BinTree::bstreeToArrayHelper(Node* node, NodeData* arr[], int& i)
 {
-    // base case: do not do anything if node is null
-    if (node == nullptr) {  
-        return;
-    }
-
-    //add left subtree data to the array
-    bstreeToArrayHelper(node->left, arr, i);   
+    //inorder walk with an explicit stack of nodes whose left subtree is
+    //being visited
+    vector<Node*> pending;
+    while (node != nullptr || !pending.empty())
+    {
+        //go as far left as possible
+        while (node != nullptr)
+        {
+            pending.push_back(node);
+            node = node->left;
+        }
 
-    //add root node data of tree to the array
-    arr[i] = new NodeData;
-    *arr[i] = *node->data;
-    i++;
+        //add root node data of the subtree to the array
+        node = pending.back();
+        pending.pop_back();
+        arr[i] = new NodeData(*node->data);
+        i++;
 
-    //add right subtree data to the array
-    bstreeToArrayHelper(node->right, arr, i);
+        //then the right subtree
+        node = node->right;
+    }
 }
 
 
@@ -575,17 +562,14 @@ BinTree::Node* BinTree::arrayToBSTreeHelper(NodeData* arr[], int left, int right
     // Get the middle element and make it root
     int mid = (left + right) / 2;
 
-    Node* node = new Node();
-    node->data = new NodeData;
-    *node->data = *arr[mid];
-    node->left = nullptr;
-    node->right = nullptr;
+    Node* node = newNode(newData(*arr[mid]), true);
 
     // create the left subtree and attach to node
     node->left = arrayToBSTreeHelper(arr, left, mid - 1);
 
     // create the right subtree and attach to node
     node->right = arrayToBSTreeHelper(arr, mid + 1, right);
+    updateHeight(node);
 
     //return the node
     return node;
@@ -601,9 +585,19 @@ void BinTree::displaySideways() const {
 }
 
 void BinTree::sidewaysHelper(Node* current, int level) const {
-    if (current != nullptr) {
-        level++;
-        sidewaysHelper(current->right, level);
+    // reverse inorder walk (right, node, left) with an explicit stack of
+    // nodes and their depth levels
+    vector<pair<Node*, int>> pending;
+    while (current != nullptr || !pending.empty()) {
+        while (current != nullptr) {
+            level++;
+            pending.push_back(make_pair(current, level));
+            current = current->right;
+        }
+
+        current = pending.back().first;
+        level = pending.back().second;
+        pending.pop_back();
 
         // indent for readability, same number of spaces per depth level 
         for (int i = level; i >= 0; i--) {
@@ -611,7 +605,7 @@ void BinTree::sidewaysHelper(Node* current, int level) const {
         }
 
         cout << *current->data << endl;        // display information of object
-        sidewaysHelper(current->left, level);
+        current = current->left;
     }
 }
 
@@ -626,29 +620,311 @@ void BinTree::makeEmpty()
     {
         root = makeEmptyHelper(root);
     }
+
+    //every node and pooled NodeData is gone: free the blocks all at once
+    nodeSlab.clear();
+    dataSlab.clear();
 }
 
 BinTree::Node* BinTree::makeEmptyHelper(Node* root) //helper for MakeEmpty()
 {
-    //empty the left subtree
-    if (root->left != nullptr)
+    //rotate left children up until the top node has none, then destroy its
+    //data and continue with its right subtree; needs no stack. The nodes
+    //themselves are not released one by one: makeEmpty frees their blocks.
+    while (root != nullptr)
+    {
+        if (root->left != nullptr)
+        {
+            Node* left = root->left;
+            root->left = left->right;
+            left->right = root;
+            root = left;
+        }
+        else
+        {
+            Node* right = root->right;
+            freeData(root->data, root->pooled);
+            root = right;
+        }
+    }
+
+    return root;
+}
+
+//---------------------------------------------------------------------------
+//setBalanced()
+//turns AVL balancing of insert and remove on or off
+//Preconditions: none
+//Postconditions: when turned on, a non-empty tree is rebuilt balanced
+//                (same elements, new shape); turning it off keeps the shape
+void BinTree::setBalanced(bool on)
+{
+    //rebuild when turning balancing on: the nodes are relinked, not copied
+    if (on && !balanced && root != nullptr)
     {
-        root->left = makeEmptyHelper(root->left);
+        vector<Node*> nodes;
+        collectNodes(root, nodes);
+        root = linkBalanced(nodes, 0, (int)nodes.size() - 1);
     }
+    balanced = on;
+}
 
-    //empty the right subtree
-    if (root->right != nullptr)
+//collectNodes()
+//helper function for setBalanced
+//appends the nodes of a subtree to the vector in order
+void BinTree::collectNodes(Node* node, vector<Node*>& nodes) const
+{
+    //inorder walk with an explicit stack, as in bstreeToArrayHelper
+    vector<Node*> pending;
+    while (node != nullptr || !pending.empty())
     {
-        root->right = makeEmptyHelper(root->right);
+        while (node != nullptr)
+        {
+            pending.push_back(node);
+            node = node->left;
+        }
+
+        node = pending.back();
+        pending.pop_back();
+        nodes.push_back(node);
+        node = node->right;
     }
+}
 
-    //empty the root
-    delete root->data;
-    root->data = nullptr;
-    delete root;
-    root = nullptr;
+//linkBalanced()
+//helper function for setBalanced
+//relinks the sorted nodes from left to right into a balanced subtree,
+//like arrayToBSTreeHelper, and returns its root
+BinTree::Node* BinTree::linkBalanced(vector<Node*>& nodes, int left,
+    int right)
+{
+    if (left > right)
+    {
+        return nullptr;
+    }
 
-    return root;
+    int mid = (left + right) / 2;
+    Node* node = nodes[mid];
+    node->left = linkBalanced(nodes, left, mid - 1);
+    node->right = linkBalanced(nodes, mid + 1, right);
+    updateHeight(node);
+    return node;
+}
+
+//---------------------------------------------------------------------------
+//isBalanced()
+//determines whether the tree is in balanced mode
+//Preconditions: none
+//Postconditions: returns true if insert and remove keep the tree balanced
+bool BinTree::isBalanced() const
+{
+    return balanced;
+}
+
+//---------------------------------------------------------------------------
+//freeze()
+//copies the tree into a read-only snapshot laid out for fast searching
+//Preconditions: none
+//Postconditions: tree is unchanged; the snapshot answers retrieve,
+//                getParent and getSibling as the tree does now
+FrozenBinTree BinTree::freeze() const
+{
+    //inorder walk with an explicit stack, as in collectNodes. Each pending
+    //node also carries what is known of its links by the time it is
+    //visited, so every parent is found as a position in the order without
+    //looking nodes up: a right child's parent was visited just before its
+    //subtree, and a left child's parent is the next node on the stack
+    struct Pending
+    {
+        Node* node;                     //node waiting to be visited
+        bool isLeft;                    //node is its parent's left child
+        int parentRank;                 //parent's position, if not isLeft
+        int leftRank;                   //left child's position, once known
+    };
+    vector<const NodeData*> sorted;
+    vector<int> parentRank;
+    vector<Pending> pending;
+    Node* node = root;
+    int rightOf = -1;                   //position of node's parent, if any
+    while (node != nullptr || !pending.empty())
+    {
+        //the first node pushed is a right child (or the root); the ones
+        //below it on the way down are left children
+        bool isLeft = false;
+        while (node != nullptr)
+        {
+            pending.push_back({ node, isLeft, isLeft ? -1 : rightOf, -1 });
+            isLeft = true;
+            node = node->left;
+        }
+
+        Pending visit = pending.back();
+        pending.pop_back();
+        int r = (int)sorted.size();
+        sorted.push_back(visit.node->data);
+        parentRank.push_back(visit.parentRank);
+        if (visit.leftRank >= 0)
+        {
+            parentRank[visit.leftRank] = r;
+        }
+        if (visit.isLeft)
+        {
+            pending.back().leftRank = r;
+        }
+        node = visit.node->right;
+        rightOf = r;
+    }
+
+    return FrozenBinTree(sorted, parentRank);
+}
+
+//---------------------------------------------------------------------------
+//insertBalanced()
+//helper for insert in balanced mode
+//inserts the data into the subtree and returns the subtree's new root;
+//inserted is set to false if the data is already in the tree
+BinTree::Node* BinTree::insertBalanced(Node* node, NodeData* ND,
+    bool pooled, bool& inserted)
+{
+    //empty spot found: the data becomes a new leaf
+    if (node == nullptr)
+    {
+        inserted = true;
+        return newNode(ND, pooled);
+    }
+
+    //left for less, right for greater; duplicates are not inserted
+    if (*ND < *node->data)
+    {
+        node->left = insertBalanced(node->left, ND, pooled, inserted);
+    }
+    else if (*ND > *node->data)
+    {
+        node->right = insertBalanced(node->right, ND, pooled, inserted);
+    }
+    else
+    {
+        return node;
+    }
+
+    return rebalance(node);
+}
+
+//rebalance()
+//updates the node's height and, if its subtrees' heights differ by two,
+//rotates it back into balance; returns the subtree's new root
+BinTree::Node* BinTree::rebalance(Node* node)
+{
+    if (node == nullptr)
+    {
+        return node;
+    }
+
+    updateHeight(node);
+    int balance = height(node->left) - height(node->right);
+
+    //left heavy: a left-right case is first turned into a left-left case
+    if (balance > 1)
+    {
+        if (height(node->left->left) < height(node->left->right))
+        {
+            node->left = rotateLeft(node->left);
+        }
+        return rotateRight(node);
+    }
+
+    //right heavy: a right-left case is first turned into a right-right case
+    if (balance < -1)
+    {
+        if (height(node->right->right) < height(node->right->left))
+        {
+            node->right = rotateRight(node->right);
+        }
+        return rotateLeft(node);
+    }
+
+    return node;
+}
+
+//rotateLeft()
+//makes the node's right child the root of the subtree and returns it
+BinTree::Node* BinTree::rotateLeft(Node* node)
+{
+    Node* child = node->right;
+    node->right = child->left;
+    child->left = node;
+    updateHeight(node);
+    updateHeight(child);
+    return child;
+}
+
+//rotateRight()
+//makes the node's left child the root of the subtree and returns it
+BinTree::Node* BinTree::rotateRight(Node* node)
+{
+    Node* child = node->left;
+    node->left = child->right;
+    child->right = node;
+    updateHeight(node);
+    updateHeight(child);
+    return child;
+}
+
+//updateHeight()
+//recomputes a node's height from its children's heights
+void BinTree::updateHeight(Node* node)
+{
+    node->height = 1 + max(height(node->left), height(node->right));
+}
+
+//height()
+//returns the height of a subtree: zero for an empty one
+int BinTree::height(Node* node) const
+{
+    return (node == nullptr) ? 0 : node->height;
+}
+
+//---------------------------------------------------------------------------
+//newNode()
+//returns a leaf node holding the data, taken from the node arena
+BinTree::Node* BinTree::newNode(NodeData* data, bool pooled)
+{
+    Node* node = new (nodeSlab.allocate()) Node;
+    node->data = data;
+    node->pooled = pooled;
+    return node;
+}
+
+//deleteNode()
+//destroys a node's data and returns the node to the node arena
+void BinTree::deleteNode(Node* node)
+{
+    freeData(node->data, node->pooled);
+    node->~Node();
+    nodeSlab.release(node);
+}
+
+//newData()
+//returns a copy of the NodeData, stored in the data arena
+NodeData* BinTree::newData(const NodeData& nd)
+{
+    return new (dataSlab.allocate()) NodeData(nd);
+}
+
+//freeData()
+//destroys a NodeData: pooled data goes back to the data arena, other data
+//was allocated by the caller of insert with new
+void BinTree::freeData(NodeData* data, bool pooled)
+{
+    if (!pooled)
+    {
+        delete data;
+    }
+    else if (data != nullptr)
+    {
+        data->~NodeData();
+        dataSlab.release(data);
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -672,17 +948,25 @@ ostream& operator<<(ostream& stream, const BinTree& tree)
 
 void BinTree::inorder(ostream& stream, Node* root) const //helper for <<
 {
-    //for nodes that are not null
-    if (root != nullptr)
+    //inorder walk with an explicit stack of nodes whose left subtree is
+    //being displayed
+    vector<Node*> pending;
+    while (root != nullptr || !pending.empty())
     {
-        //display left subtree
-        inorder(stream, root->left);
-        
+        //display left subtree first
+        while (root != nullptr)
+        {
+            pending.push_back(root);
+            root = root->left;
+        }
+
         //display root node
+        root = pending.back();
+        pending.pop_back();
         stream << *(root->data) << " ";
 
         //display right subtree
-        inorder(stream, root->right);
+        root = root->right;
     }
 }
 
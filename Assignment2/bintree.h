@@ -14,13 +14,35 @@
 // -- trees that are equal contain the same elements AND the same shape
 // -- converting from an array to a tree nullifies all elements in the tree
 // -- in <<, an inorder traversal of the tree is performed (left, root, right)
-// -- most functionality is implemented recursively = many helper functions
+// -- traversals use explicit stacks instead of recursion, so a degenerate
+//    (e.g. sorted insert) tree is limited only by memory, not by call stack
+//    depth; only helpers whose depth is O(log n) (arrayToBSTree and the
+//    balanced-mode insert and rebuild) recurse
+// -- nodes come from an arena (see slab.h) owned by the tree, in contiguous
+//    blocks; makeEmpty frees the blocks all at once instead of node by node
+// -- insertCopy stores the NodeData in a second arena as well, so a tree
+//    built with it makes no heap allocation per element (beyond what the
+//    NodeData itself allocates); insert still takes a NodeData from new.
+//    Copies the tree makes itself (copy constructor, =, arrayToBSTree) are
+//    also kept in that arena
+// -- freeze() copies the tree into a FrozenBinTree: a read-only, pointer
+//    free layout for trees that are searched far more than they change
+// -- the arenas reuse the memory of removed nodes but only give memory back
+//    to the heap when the tree is emptied or destroyed
+// -- in balanced mode (setBalanced), insert and remove keep the tree AVL
+//    balanced by rotating nodes, so subtree heights differ by at most one
+//    and retrieve, remove, getParent and getSibling take O(log n); the
+//    shape then depends on the balancing, not only on the insert order
+// -- getParent and getSibling follow the search path from the root
 //---------------------------------------------------------------------------
 #ifndef BINTREE_H
 #define BINTREE_H
 
 #include <iostream>
+#include <vector>
 #include "nodedata.h"
+#include "slab.h"
+#include "frozenbintree.h"
 
 using namespace std;
 class BinTree
@@ -80,6 +102,13 @@ public:
     //Postconditions: returns true if the node was inserted successfully
     bool insert(NodeData*);
 
+    //insertCopy()
+    //inserts a copy of the NodeData, stored in the tree's own arena
+    //Preconditions: NodeData must not have an empty string
+    //Postconditions: returns true if the copy was inserted successfully;
+    //                the argument is not kept by the tree
+    bool insertCopy(const NodeData&);
+
     //remove()
     //removes and fills in a pointer to the desired node
     //Preconditions: two arguments must be provided
@@ -128,6 +157,26 @@ public:
     //Postconditions: tree is empty
     void makeEmpty();
 
+    //setBalanced()
+    //turns AVL balancing of insert and remove on or off
+    //Preconditions: none
+    //Postconditions: when turned on, a non-empty tree is rebuilt balanced
+    //                (same elements, new shape); turning it off keeps the shape
+    void setBalanced(bool);
+
+    //isBalanced()
+    //determines whether the tree is in balanced mode
+    //Preconditions: none
+    //Postconditions: returns true if insert and remove keep the tree balanced
+    bool isBalanced() const;
+
+    //freeze()
+    //copies the tree into a read-only snapshot laid out for fast searching
+    //Preconditions: none
+    //Postconditions: tree is unchanged; the snapshot answers retrieve,
+    //                getParent and getSibling as the tree does now
+    FrozenBinTree freeze() const;
+
 private:
 
     //Node
@@ -135,16 +184,23 @@ private:
     //1) a data pointer to a NodeData object holding a string of data 
     //2) a left pointer to the left child of the given node
     //3) a right pointer to the right child of the given node
+    //and the height of the subtree rooted at the node (a leaf has height 1),
+    //which is only kept up to date in balanced mode
     struct Node
     {
-        NodeData* data;                 //pointer to object of data stored
-        Node* left;                     //pointer to left node
-        Node* right;                    //pointer to right node
+        NodeData* data = nullptr;       //pointer to object of data stored
+        Node* left = nullptr;           //pointer to left node
+        Node* right = nullptr;          //pointer to right node
+        int height = 1;                 //height of this subtree
+        bool pooled = false;            //data is in dataSlab, not from new
     };
 
     Node* root = nullptr;               //root of the binary search tree
+    bool balanced = false;              //whether insert/remove rebalance
+    Slab<Node> nodeSlab;                //memory for every node
+    Slab<NodeData> dataSlab;            //memory for data the tree copied
 
-    //Helper functions: used for recursive implementation
+    //Helper functions: used by the public functions above
     void sidewaysHelper(Node* current, int level) const;
     Node* copy(Node* source, Node* dest);
     Node* makeEmptyHelper(Node* root);
@@ -153,10 +209,26 @@ private:
     bool retrieveHelper(const NodeData&, NodeData*&, Node*) const;
     Node* removeHelper(const NodeData&, NodeData*&, Node*);
     Node* removeNode(Node*&);
-    Node* predecessor(Node*, Node*&) const;
+    Node* removeMax(Node*, Node*&);
     Node* arrayToBSTreeHelper(NodeData* [], int, int);
     void bstreeToArrayHelper(Node*, NodeData* [], int&);
-    Node* getSiblingHelper(Node*, NodeData) const;
-    Node* getParentHelper(Node*, NodeData) const;
+    Node* findParent(const NodeData&, Node*&) const;
+    bool insertData(NodeData*, bool);
+
+    //Arena helpers: every node, and every NodeData the tree copies itself
+    Node* newNode(NodeData*, bool);
+    void deleteNode(Node*);
+    NodeData* newData(const NodeData&);
+    void freeData(NodeData*, bool);
+
+    //Balancing helpers: used in balanced mode
+    Node* insertBalanced(Node*, NodeData*, bool, bool&);
+    Node* rebalance(Node*);
+    Node* rotateLeft(Node*);
+    Node* rotateRight(Node*);
+    void updateHeight(Node*);
+    int height(Node*) const;
+    void collectNodes(Node*, vector<Node*>&) const;
+    Node* linkBalanced(vector<Node*>&, int, int);
 };
 #endif
@@ -0,0 +1,172 @@
+#include "frozenbintree.h"
+
+//---------------------------------------------------------------------------
+//default constructor
+//creates an empty snapshot
+//Preconditions: none
+//Postconditions: nothing can be retrieved
+FrozenBinTree::FrozenBinTree()
+{
+    //slot 0 is never used, so even an empty snapshot has it
+    data.resize(1);
+    parent.resize(1, 0);
+    sibling.resize(1, 0);
+}
+
+//---------------------------------------------------------------------------
+//constructor used by BinTree::freeze()
+//lays the sorted data out in Eytzinger order, then converts the parent
+//ranks into slots and works out each slot's sibling
+FrozenBinTree::FrozenBinTree(const vector<const NodeData*>& sorted,
+    const vector<int>& parentRank)
+{
+    int count = (int)sorted.size();
+    data.resize(count + 1);
+    parent.resize(count + 1, 0);
+    sibling.resize(count + 1, 0);
+
+    //slotOf[r] is the slot that the r-th smallest data ends up in
+    vector<int> slotOf(count);
+    int next = 0;
+    layout(sorted, slotOf, next, 1);
+
+    //record each slot's parent slot
+    for (int r = 0; r < count; r++)
+    {
+        if (parentRank[r] >= 0)
+        {
+            parent[slotOf[r]] = slotOf[parentRank[r]];
+        }
+    }
+
+    //a parent has at most two children, one smaller and one larger than
+    //itself; two children of the same parent are each other's sibling
+    vector<int> smaller(count + 1, 0);
+    vector<int> larger(count + 1, 0);
+    for (int r = 0; r < count; r++)
+    {
+        if (parentRank[r] >= 0)
+        {
+            int p = slotOf[parentRank[r]];
+            (r < parentRank[r] ? smaller[p] : larger[p]) = slotOf[r];
+        }
+    }
+    for (int p = 1; p <= count; p++)
+    {
+        if (smaller[p] != 0 && larger[p] != 0)
+        {
+            sibling[smaller[p]] = larger[p];
+            sibling[larger[p]] = smaller[p];
+        }
+    }
+}
+
+//layout()
+//helper for the constructor
+//fills the subtree of slot k with the next data in order, like an inorder
+//walk of the implicit tree; recursion depth is log2 of the data count
+void FrozenBinTree::layout(const vector<const NodeData*>& sorted,
+    vector<int>& slotOf, int& next, int k)
+{
+    if (k < (int)data.size())
+    {
+        layout(sorted, slotOf, next, 2 * k);
+        data[k] = *sorted[next];
+        slotOf[next] = k;
+        next++;
+        layout(sorted, slotOf, next, 2 * k + 1);
+    }
+}
+
+//---------------------------------------------------------------------------
+//retrieve()
+//finds the data equal to the target and provides a pointer to it
+//Preconditions: two arguments must be provided
+//Postconditions: returns true if the data could be retrieved; the
+//                pointer stays valid as long as the snapshot exists
+bool FrozenBinTree::retrieve(const NodeData& target,
+    const NodeData*& actual) const
+{
+    int k = find(target);
+    if (k != 0)
+    {
+        actual = &data[k];
+    }
+    return k != 0;
+}
+
+//find()
+//returns the slot holding data equal to the key, or 0 if there is none
+int FrozenBinTree::find(const NodeData& key) const
+{
+    //descend without branching on the comparison: right when key is
+    //larger. Slots 4k to 4k + 3 are the next-but-one level, two cache lines
+    //for 32-byte NodeData, so fetch them while comparing here (only while
+    //they exist: a pointer past the end of the array may not be formed)
+    size_t count = data.size() - 1;
+    size_t k = 1;
+    while (k <= count)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        if (4 * k <= count)
+        {
+            __builtin_prefetch(data.data() + 4 * k);
+        }
+#endif
+        k = 2 * k + (size_t)(data[k] < key);
+    }
+
+    //the last left turn was at the smallest data not less than the key:
+    //drop the trailing right turns (one bits), then that left turn
+    while ((k & 1) != 0)
+    {
+        k >>= 1;
+    }
+    k >>= 1;
+
+    return (k != 0 && data[k] == key) ? (int)k : 0;
+}
+
+//---------------------------------------------------------------------------
+//getSibling()
+//finds the other node that had the same parent in the BinTree
+//Preconditions: two arguments must be provided
+//Postconditions: returns true if the sibling could be found
+bool FrozenBinTree::getSibling(const NodeData& target, NodeData& copy) const
+{
+    int k = find(target);
+    if (k == 0 || sibling[k] == 0)
+    {
+        return false;
+    }
+
+    copy = data[sibling[k]];
+    return true;
+}
+
+//---------------------------------------------------------------------------
+//getParent()
+//finds the parent the node had in the BinTree
+//Preconditions: two arguments must be provided
+//Postconditions: returns true if the parent could be retrieved
+bool FrozenBinTree::getParent(const NodeData& target, NodeData& copy) const
+{
+    int k = find(target);
+    if (k == 0 || parent[k] == 0)
+    {
+        return false;
+    }
+
+    copy = data[parent[k]];
+    return true;
+}
+
+//---------------------------------------------------------------------------
+//isEmpty()
+//determines whether the snapshot holds no data
+//Preconditions: none
+//Postconditions: returns true if the frozen tree was empty
+bool FrozenBinTree::isEmpty() const
+{
+    return data.size() == 1;
+}
@@ -0,0 +1,82 @@
+//---------------------------------------------------------------------------
+// class FrozenBinTree
+// Developer: Yash Varde
+//---------------------------------------------------------------------------
+// ADT FrozenBinTree: a read-only snapshot of a BinTree, made by
+// BinTree::freeze(), for trees that are built once and then searched many
+// times
+// -- answers retrieve, getParent and getSibling like the BinTree it was
+//    made from; parents and siblings are those of the BinTree's shape
+// -- later changes to the BinTree do not affect the snapshot
+//
+// Implementation and Assumptions:
+// -- the data is copied into one array in Eytzinger (breadth-first) order:
+//    the children of slot k are slots 2k and 2k + 1, with slot 0 unused.
+//    The top levels of every search share the first few cache lines, and
+//    a search never follows a pointer between nodes
+// -- a search descends with k = 2k + (key > data[k]), with no branch on
+//    the comparison, and prefetches the slots two levels further down
+// -- for each slot, the slots of its BinTree parent and sibling are stored
+//    in two int arrays alongside (0 when there is none)
+// -- short strings are stored inside NodeData itself, so for them the
+//    search touches only the array; longer strings add one access each
+//---------------------------------------------------------------------------
+#ifndef FROZENBINTREE_H
+#define FROZENBINTREE_H
+
+#include <vector>
+#include "nodedata.h"
+
+using namespace std;
+class FrozenBinTree
+{
+    friend class BinTree;
+
+public:
+    //default constructor
+    //creates an empty snapshot
+    //Preconditions: none
+    //Postconditions: nothing can be retrieved
+    FrozenBinTree();
+
+    //retrieve()
+    //finds the data equal to the target and provides a pointer to it
+    //Preconditions: two arguments must be provided
+    //Postconditions: returns true if the data could be retrieved; the
+    //                pointer stays valid as long as the snapshot exists
+    bool retrieve(const NodeData&, const NodeData*&) const;
+
+    //getSibling()
+    //finds the other node that had the same parent in the BinTree
+    //Preconditions: two arguments must be provided
+    //Postconditions: returns true if the sibling could be found
+    bool getSibling(const NodeData&, NodeData&) const;
+
+    //getParent()
+    //finds the parent the node had in the BinTree
+    //Preconditions: two arguments must be provided
+    //Postconditions: returns true if the parent could be retrieved
+    bool getParent(const NodeData&, NodeData&) const;
+
+    //isEmpty()
+    //determines whether the snapshot holds no data
+    //Preconditions: none
+    //Postconditions: returns true if the frozen tree was empty
+    bool isEmpty() const;
+
+private:
+    vector<NodeData> data;              //data in Eytzinger order, from 1
+    vector<int> parent;                 //slot of each slot's parent
+    vector<int> sibling;                //slot of each slot's sibling
+
+    //constructor used by BinTree::freeze()
+    //sorted holds the tree's data in order, and parentRank the position in
+    //sorted of each one's parent (-1 for the root)
+    FrozenBinTree(const vector<const NodeData*>& sorted,
+        const vector<int>& parentRank);
+
+    //Helper functions
+    int find(const NodeData&) const;
+    void layout(const vector<const NodeData*>&, vector<int>&, int&, int);
+};
+#endif
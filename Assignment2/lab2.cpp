@@ -128,13 +128,9 @@ void buildTree(BinTree& t, ifstream& infile) {
         }
 
         // in an object-oriented program, change to setData() for reading 
-        NodeData* ptr = new NodeData(s);
-
-        bool success = t.insert(ptr);
-        if (!success) {
-            delete ptr;                       // duplicate case, not inserted 
-            ptr = nullptr;
-        }
+        // the tree copies the data into its own arena; a duplicate is not
+        // inserted and nothing is left to delete
+        t.insertCopy(NodeData(s));
     }
 }
 
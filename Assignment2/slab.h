@@ -0,0 +1,129 @@
+//---------------------------------------------------------------------------
+// class Slab<T>
+// Developer: Yash Varde
+//---------------------------------------------------------------------------
+// ADT Slab: an arena that hands out memory for objects of one type from
+// large contiguous blocks instead of one heap allocation per object
+// -- allocate() returns uninitialized memory for one T; the caller
+//    constructs the object in it with placement new
+// -- release() takes back the memory of one object, which the caller must
+//    already have destroyed, so the next allocate() can reuse it
+// -- clear() frees every block at once, in O(blocks), without running any
+//    destructor: objects still alive must be destroyed first, or need none
+//
+// Implementation and Assumptions:
+// -- blocks start small and double in size up to MAX_BLOCK_SLOTS, so small
+//    trees waste little memory and large ones need few blocks
+// -- released slots are kept on a free list threaded through the slots and
+//    are only returned to the heap by clear() or the destructor
+// -- a Slab cannot be copied; each owner keeps its own
+//---------------------------------------------------------------------------
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <cstddef>
+#include <vector>
+using namespace std;
+
+template <class T>
+class Slab
+{
+public:
+    // Constructor
+    // Creates an empty arena: no block is allocated until the first use
+    // Preconditions: none
+    // Postconditions: the arena holds no memory
+    Slab() = default;
+
+    // Destructor
+    // Preconditions: objects in the arena must not be used afterwards
+    // Postconditions: every block is freed (no destructors are run)
+    ~Slab()
+    {
+        clear();
+    }
+
+    Slab(const Slab&) = delete;
+    Slab& operator = (const Slab&) = delete;
+
+    // allocate()
+    // returns memory for one T, reusing a released slot if there is one
+    // Preconditions: none
+    // Postconditions: the memory is uninitialized
+    void* allocate()
+    {
+        //reuse the most recently released slot
+        if (freeList != nullptr)
+        {
+            Slot* slot = freeList;
+            freeList = slot->next;
+            return slot->storage;
+        }
+
+        //otherwise take the next slot of the newest block
+        if (nextSlot == endSlot)
+        {
+            addBlock();
+        }
+        return (nextSlot++)->storage;
+    }
+
+    // release()
+    // returns the memory of one object to the arena
+    // Preconditions: the object came from allocate() and has been destroyed
+    // Postconditions: the memory may be handed out again by allocate()
+    void release(void* memory)
+    {
+        Slot* slot = static_cast<Slot*>(memory);
+        slot->next = freeList;
+        freeList = slot;
+    }
+
+    // clear()
+    // frees every block at once
+    // Preconditions: objects in the arena are destroyed or need no destructor
+    // Postconditions: the arena holds no memory
+    void clear()
+    {
+        for (Slot* block : blocks)
+        {
+            delete[] block;
+        }
+        blocks.clear();
+        freeList = nextSlot = endSlot = nullptr;
+        blockSlots = MIN_BLOCK_SLOTS;
+    }
+
+private:
+    static const int MIN_BLOCK_SLOTS = 32;          //slots in the first block
+    static const int MAX_BLOCK_SLOTS = 4096;        //largest block, in slots
+
+    //Slot
+    //room for one T, or the free list link once it has been released
+    union Slot
+    {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    vector<Slot*> blocks;               //every block, to free them
+    Slot* freeList = nullptr;           //released slots
+    Slot* nextSlot = nullptr;           //next unused slot of the newest block
+    Slot* endSlot = nullptr;            //end of the newest block
+    int blockSlots = MIN_BLOCK_SLOTS;   //size of the next block
+
+    // addBlock()
+    // allocates the next block and makes its slots the unused ones
+    void addBlock()
+    {
+        Slot* block = new Slot[blockSlots];
+        blocks.push_back(block);
+        nextSlot = block;
+        endSlot = block + blockSlots;
+        if (blockSlots < MAX_BLOCK_SLOTS)
+        {
+            blockSlots *= 2;
+        }
+    }
+};
+#endif